@@ -1,19 +1,30 @@
 #include "Actor.h"
 #include "StudentWorld.h"
+#include <algorithm>
+#include <utility>
 
 using namespace std;
 
+//How long a boulder waits after the earth under it has gone before it falls
+const int ticksBeforeBoulderFalls = 30;
+
 /*                          Actor class method implementations:                         */
 
-Actor::Actor(StudentWorld* myWorld, int imageID, int startX, int startY, Direction dir, double size, unsigned int depth) : GraphObject(imageID, startX, startY, dir, size, depth){
+Actor::Actor(StudentWorld* myWorld, ActorKind kind, int imageID, int startX, int startY, Direction dir, double size, unsigned int depth) : GraphObject(imageID, startX, startY, dir, size, depth){
     
     m_world = myWorld;
+    m_kind = kind;
+    m_listIndex = -1;
+    m_updateIndex = -1;
+    m_timer.owner = this;
+    m_awaitedEvent = eventNone;
     setVisible(false); //All actors start out as not visible
     setLiveStatus(true); //All actors start out as alive
 }
 
 void Actor::setLiveStatus(bool b){
     m_isAlive = b;
+    m_world->actorTurnStateChanged(this);
 }
 bool Actor::getLiveStatus() const{
     return m_isAlive;
@@ -23,35 +34,95 @@ StudentWorld* Actor::getWorld() const{
     return m_world;
 }
 
+char Actor::getGameID() const{
+    //Indexed by ActorKind
+    static const char gameIDs[] = {'T', 'B', 'O', 'W', 'K', 'G', 'S', 'p', 'P'};
+    return gameIDs[m_kind];
+}
+
+void Actor::suspendFor(int ticks){
+    m_world->scheduleWakeUp(this, m_world->getTickNumber() + ticks);
+}
+
+void Actor::suspendUntil(WorldEvent e){
+    m_awaitedEvent = e;
+    m_world->actorTurnStateChanged(this);
+}
+
+void Actor::interrupt(int turnsToSkip){
+    m_awaitedEvent = eventNone;
+    if(turnsToSkip <= 0){
+        m_world->cancelWakeUp(this);
+        return;
+    }
+    //The next turn is this tick's unless the actor has had it already
+    unsigned int nextTurn = m_world->getTickNumber() + (m_world->hasHadTurnThisTick(this) ? 1 : 0);
+    m_world->scheduleWakeUp(this, nextTurn + turnsToSkip);
+}
+
+void Actor::signal(WorldEvent e){
+    if(m_awaitedEvent != e)
+        return;
+    m_awaitedEvent = eventNone;
+    m_world->actorTurnStateChanged(this);
+}
+
+bool Actor::isScheduled() const{
+    return m_timer.isScheduled();
+}
+
+int Actor::turnsToSleep() const{
+    int turns = static_cast<int>(m_timer.dueTick - m_world->getTickNumber());
+    if(m_world->hasHadTurnThisTick(this))
+        turns--;
+    return turns;
+}
+
+TimerNode& Actor::getTimer(){
+    return m_timer;
+}
+
+void Actor::setBehavior(ActorTask behavior){
+    m_behavior = std::move(behavior);
+}
+
 void Actor::move(){
-    if(getDirection() == up && getY() < VIEW_HEIGHT-actorSize)
+    if(getDirection() == up && getY() < getWorld()->getFieldHeight()-actorSize)
         moveTo(getX(), getY()+1);
     else if(getDirection() == down && getY() > 0)
         moveTo(getX(), getY() - 1);
-    else if(getDirection() == right && getX() < VIEW_WIDTH-actorSize)
+    else if(getDirection() == right && getX() < getWorld()->getFieldWidth()-actorSize)
         moveTo(getX()+1, getY());
     else if(getDirection() == left && getX() > 0)
         moveTo(getX() - 1, getY());
+    getWorld()->actorMoved(this);
 }
 
 
 
-/*                          Earth class method implementations:                 */
-
-Earth::Earth(StudentWorld* myWorld, int startX, int startY) : Actor(myWorld, TID_EARTH, startX, startY, right, 0.25, 3){
-    
-    setVisible(true); //Earths are set to be visible when they are created
+void Actor::saveState(ActorRecord& r) const{
+    r = ActorRecord();
+    r.gameID = getGameID();
+    r.direction = static_cast<uint8_t>(getDirection());
+    r.visible = isVisible();
+    r.alive = getLiveStatus();
+    r.x = static_cast<int16_t>(getX());
+    r.y = static_cast<int16_t>(getY());
 }
 
-char Earth::getGameID() const{
-    return 'E'; //Earths have a character ID of 'E'
+void Actor::restoreState(const ActorRecord& r){
+    setDirection(static_cast<Direction>(r.direction));
+    setVisible(r.visible != 0);
+    setLiveStatus(r.alive != 0);
+    moveTo(r.x, r.y);
+    jumpToDestination(); //Don't animate a slide from wherever the constructor put the actor
 }
 
 
 
 /*                          TunnelMan class method implementations                  */
 
-TunnelMan::TunnelMan(StudentWorld* myWorld) : Actor(myWorld, TID_PLAYER, 30, 60){
+TunnelMan::TunnelMan(StudentWorld* myWorld) : Actor(myWorld, kindTunnelMan, TID_PLAYER, myWorld->getFieldWidth()/2 - 2, myWorld->getFieldHeight() - actorSize){
     m_numSquirts = 5;
     m_numSonarCharges = 1;
     m_numGoldNuggets = 0;
@@ -61,10 +132,6 @@ TunnelMan::TunnelMan(StudentWorld* myWorld) : Actor(myWorld, TID_PLAYER, 30, 60)
     setVisible(true); //TunnelMan starts out as visible
 }
 
-char TunnelMan::getGameID() const{
-    return 'T';
-}
-
 void TunnelMan::doSomething(){
     if(!getLiveStatus()){
         return;
@@ -185,6 +252,24 @@ int TunnelMan::getNumBarrelsFound(){
 int TunnelMan::getHitPoints(){
     return m_hitPoints;
 }
+
+void TunnelMan::saveState(ActorRecord& r) const{
+    Actor::saveState(r);
+    r.state[0] = m_numSquirts;
+    r.state[1] = m_numSonarCharges;
+    r.state[2] = m_numGoldNuggets;
+    r.state[3] = m_numBarrelsFound;
+    r.state[4] = m_hitPoints;
+}
+
+void TunnelMan::restoreState(const ActorRecord& r){
+    Actor::restoreState(r);
+    m_numSquirts = r.state[0];
+    m_numSonarCharges = r.state[1];
+    m_numGoldNuggets = r.state[2];
+    m_numBarrelsFound = r.state[3];
+    m_hitPoints = r.state[4];
+}
 void TunnelMan::annoy(int howMuch){
     m_hitPoints -= howMuch;
     if(m_hitPoints <= 0){
@@ -216,56 +301,43 @@ void TunnelMan::introduceSquirt(){
 
 /*                          Boulder class method implementations:                   */
 
-Boulder::Boulder(StudentWorld* myWorld, int startX, int startY) : Actor(myWorld, TID_BOULDER, startX, startY, down, 1, 1.0){
+Boulder::Boulder(StudentWorld* myWorld, int startX, int startY) : Actor(myWorld, kindBoulder, TID_BOULDER, startX, startY, down, 1, 1.0){
     setVisible(true); //Boulders start out visible
     
     getWorld()->removeEarth(startX, startY);
-    state = 0; //Boulders start out in a stable state (0 = stable, 1 = waiting, 2 = falling)
-    ticksElapsed = -1; //To track how many ticks have elapsed after entering waiting state. ticksElapsed = -1 when the boulder is not in a waiting state
-}
-
-char Boulder::getGameID() const{
-    return 'B';
+    m_stage = stageStable; //Boulders start out in a stable state
+    setBehavior(behave());
 }
 
 void Boulder::doSomething(){
     if(!getLiveStatus())
         return;
+    resumeBehavior();
+}
 
-    if(state == 0){ //Stable state
-        if(boulderCanFall()){
-            state = 1; //Waiting state
-            ticksElapsed++;
-            return;
-        }
+ActorTask Boulder::behave(){
+    if(m_stage == stageStable){
+        while(!boulderCanFall())
+            co_await worldEvent(eventGroundOpenedBelow); //Nothing can change until then
+        m_stage = stageWaiting;
+        co_await ticks(ticksBeforeBoulderFalls + 1);
     }
-
-    if(state == 1){ //Waiting state
-        int ticksBeforeBoulderFalls = 30; 
-        if(ticksElapsed >= ticksBeforeBoulderFalls){
-            state = 2; //Falling state
-            getWorld()->playSound(SOUND_FALLING_ROCK);
-            ticksElapsed = -1;
-        }
-        else{
-            ticksElapsed++;
-        }
-        return;
+    if(m_stage == stageWaiting){
+        m_stage = stageFalling;
+        getWorld()->playSound(SOUND_FALLING_ROCK);
+        co_await ticks(1);
     }
-    if(state == 2){//Falling state
-        if(boulderCanFall()){
-            getWorld()->playSound(SOUND_FALLING_ROCK);
-            smushCharacters();
-            move();
-        }
-        else{
-            setLiveStatus(false); //Set the boulder to dead
-        }
+    while(boulderCanFall()){
+        getWorld()->playSound(SOUND_FALLING_ROCK);
+        smushCharacters();
+        move();
+        co_await ticks(1);
     }
+    setLiveStatus(false); //Set the boulder to dead
 }
 
 void Boulder::smushCharacters(){
-    getWorld()->killProtestorsWithinRadius(getX(), getY(), 4);
+    getWorld()->annoyProtestorsWithinRadius(getX(), getY(), 4, 100, 0);
     
     if(getWorld()->tunnelManWithinRadius(getX(), getY(), 4)){
         getWorld()->getTunnelMan()->annoy(100);
@@ -275,19 +347,36 @@ bool Boulder::boulderCanFall() const{
     return !getWorld()->willHitBoulderEdgeOrEarth(getX(), getY(), down);
 }
 
+void Boulder::saveState(ActorRecord& r) const{
+    Actor::saveState(r);
+    r.state[0] = m_stage;
+    r.state[1] = -1; //Ticks a waiting boulder has waited so far
+    if(m_stage == stageWaiting)
+        r.state[1] = isScheduled() ? ticksBeforeBoulderFalls - turnsToSleep() : ticksBeforeBoulderFalls;
+}
+
+void Boulder::restoreState(const ActorRecord& r){
+    Actor::restoreState(r);
+    m_stage = static_cast<Stage>(r.state[0]);
+    //Sleep through the rest of the wait; the behavior starts falling as soon as it's over
+    int ticksWaited = r.state[1];
+    if(m_stage == stageWaiting && ticksWaited < ticksBeforeBoulderFalls)
+        suspendFor(ticksBeforeBoulderFalls - ticksWaited + 1);
+}
+
 
 
 /*                      Goodie Class Function Implementations:                  */
 
-Goodie::Goodie(StudentWorld* myWorld, int imageID, int startX, int startY, bool tunnelManCanPickUp, bool temp) : Actor(myWorld, imageID, startX, startY, right, 1.0, 2){
+Goodie::Goodie(StudentWorld* myWorld, ActorKind kind, int imageID, int startX, int startY, bool tunnelManCanPickUp, bool temp) : Actor(myWorld, kind, imageID, startX, startY, right, 1.0, 2){
     //Goodies start out as invisible
     m_tunnelManCanPickUp = tunnelManCanPickUp;
     
     m_temporary = temp;
+    m_triggered = false;
     
     if(m_temporary)
-        //TODO: fix this
-        m_tickLifeTime = fmax(100, 300 - 10*getWorld()->getLevel());
+        m_tickLifeTime = getWorld()->getLevelParams().goodieLifetime;
     else
         m_tickLifeTime = -1;
     m_tickCount = 0;
@@ -297,20 +386,62 @@ void Goodie::setTickLifeTime(int tickLife){
     m_tickLifeTime = tickLife;
 }
 
+bool Goodie::isTemporary() const{
+    return m_temporary;
+}
+
+bool Goodie::canBePickedUp() const{
+    return m_tunnelManCanPickUp;
+}
+
+void Goodie::wakeUp(){
+    m_tickCount = m_tickLifeTime;
+}
+
+bool Goodie::isTriggered() const{
+    return m_triggered;
+}
+
+void Goodie::setTriggered(bool b){
+    m_triggered = b;
+    getWorld()->actorTurnStateChanged(this);
+}
+
+void Goodie::saveState(ActorRecord& r) const{
+    Actor::saveState(r);
+    r.state[0] = m_tunnelManCanPickUp;
+    r.state[1] = m_temporary;
+    r.state[2] = m_tickLifeTime;
+    r.state[3] = m_tickCount;
+    if(isScheduled())
+        r.state[3] = m_tickLifeTime - turnsToSleep();
+}
+
+void Goodie::restoreState(const ActorRecord& r){
+    Actor::restoreState(r);
+    m_tunnelManCanPickUp = r.state[0] != 0;
+    m_temporary = r.state[1] != 0;
+    m_tickLifeTime = r.state[2];
+    m_tickCount = r.state[3];
+}
+
 void Goodie::doSomething(){
     if(!getLiveStatus())
         return;
     
-    if(m_temporary){
+    //While it sleeps on the timing wheel a goodie is part way through its lifetime, so there's nothing to count
+    if(m_temporary && !isScheduled()){
         if(m_tickCount >= m_tickLifeTime){
             setLiveStatus(false);
             return;
         }
+        else if(m_tunnelManCanPickUp) //only the TunnelMan coming near can make it act before it expires
+            suspendFor(m_tickLifeTime - m_tickCount);
         else
             m_tickCount++;
     }
     
-    if(!isVisible() && getWorld()->tunnelManWithinRadius(getX(), getY(), 4)){
+    if(!isVisible() && getWorld()->tunnelManWithinRadius(getX(), getY(), goodieRevealRadius)){
         setVisible(true);
         return;
     }
@@ -321,8 +452,7 @@ void Goodie::doSomething(){
     }
     
     if(!m_tunnelManCanPickUp){
-        vector<Actor*> protestors = getWorld()->findProtestorsWithinRadius(getX(), getY(), 3);
-        if(protestors.size() != 0){
+        if(getWorld()->findProtestorWithinRadius(getX(), getY(), 3) != nullptr){
             doSomethingToProtestor();
             setLiveStatus(false);
         }
@@ -333,15 +463,11 @@ void Goodie::doSomething(){
 
 /*                          Barrel Class Function Implementations                   */
 
-Barrel::Barrel(StudentWorld* myWorld, int startX, int startY) : Goodie(myWorld, TID_BARREL, startX, startY, true, false){
+Barrel::Barrel(StudentWorld* myWorld, int startX, int startY) : Goodie(myWorld, kindBarrel, TID_BARREL, startX, startY, true, false){
     
     //Barrels start out as invisible
 }
 
-char Barrel::getGameID() const{
-    return 'O'; //Barrels have a character/game ID of 'O' (Oil)
-}
-
 void Barrel::doSomethingToTunnelMan(){
     getWorld()->playSound(SOUND_FOUND_OIL);
     getWorld()->increaseScore(1000);
@@ -352,14 +478,10 @@ void Barrel::doSomethingToTunnelMan(){
 
 /*                          Waterpool Class Function Implementations                   */
 
-WaterPool::WaterPool(StudentWorld* myWorld, int startX, int startY) : Goodie(myWorld, TID_WATER_POOL, startX, startY, true, true){
+WaterPool::WaterPool(StudentWorld* myWorld, int startX, int startY) : Goodie(myWorld, kindWaterPool, TID_WATER_POOL, startX, startY, true, true){
     setVisible(true);
 }
 
-char WaterPool::getGameID() const{
-    return 'W';
-}
-
 void WaterPool::doSomethingToTunnelMan(){
     getWorld()->playSound(SOUND_GOT_GOODIE);
     getWorld()->getTunnelMan()->incrementNumSquirts();
@@ -371,14 +493,10 @@ void WaterPool::doSomethingToTunnelMan(){
 
 /*                          SonarKit Class Function Implementations                   */
 
-SonarKit::SonarKit(StudentWorld* myWorld) : Goodie(myWorld, TID_SONAR, 0, 60, true, true){
+SonarKit::SonarKit(StudentWorld* myWorld) : Goodie(myWorld, kindSonarKit, TID_SONAR, 0, myWorld->getFieldHeight() - actorSize, true, true){
     setVisible(true);
 }
 
-char SonarKit::getGameID() const{
-    return 'K';
-}
-
 void SonarKit::doSomethingToTunnelMan(){
     getWorld()->playSound(SOUND_GOT_GOODIE);
     getWorld()->getTunnelMan()->incrementNumSonarCharges();
@@ -389,7 +507,7 @@ void SonarKit::doSomethingToTunnelMan(){
 
 /*                          Gold Class Function Implementations                   */
 
-Gold::Gold(StudentWorld* myWorld, int startX, int startY, bool tunnelManCanPickUp) : Goodie(myWorld, TID_GOLD, startX, startY, tunnelManCanPickUp, !tunnelManCanPickUp){
+Gold::Gold(StudentWorld* myWorld, int startX, int startY, bool tunnelManCanPickUp) : Goodie(myWorld, kindGold, TID_GOLD, startX, startY, tunnelManCanPickUp, !tunnelManCanPickUp){
     
     if(!tunnelManCanPickUp){
         setVisible(true);
@@ -397,10 +515,6 @@ Gold::Gold(StudentWorld* myWorld, int startX, int startY, bool tunnelManCanPickU
     }
 }
 
-char Gold::getGameID() const{
-    return 'G';
-}
-
 void Gold::doSomethingToTunnelMan(){
 
     getWorld()->playSound(SOUND_GOT_GOODIE);
@@ -417,18 +531,14 @@ void Gold::doSomethingToProtestor(){
 
 
 /*                          Squirt Class Implementation                                 */
-Squirt::Squirt(StudentWorld* myWorld, int startX, int startY) : Actor(myWorld, TID_WATER_SPURT, startX, startY, myWorld->getTunnelMan()->getDirection(), 1.0, 1){
+Squirt::Squirt(StudentWorld* myWorld, int startX, int startY) : Actor(myWorld, kindSquirt, TID_WATER_SPURT, startX, startY, myWorld->getTunnelMan()->getDirection(), 1.0, 1){
     m_travelDistance = 4; //All squirts start out with an initial travel distance of 4
     setVisible(true);
 }
 
-char Squirt::getGameID() const{
-    return 'S';
-}
-
 void Squirt::doSomething(){
     
-    if(getWorld()->squirtProtestorWithinRadius(getX(), getY(), 3)){
+    if(getWorld()->annoyProtestorsWithinRadius(getX(), getY(), 3, 2, 1) > 0){
         setLiveStatus(false);
         return;
     }
@@ -446,78 +556,95 @@ void Squirt::doSomething(){
     m_travelDistance--;
 }
 
+void Squirt::saveState(ActorRecord& r) const{
+    Actor::saveState(r);
+    r.state[0] = m_travelDistance;
+}
+
+void Squirt::restoreState(const ActorRecord& r){
+    Actor::restoreState(r);
+    m_travelDistance = r.state[0];
+}
+
 
 
 /*                      Protestor Class function implementations:                       */
 
-Protestor::Protestor(StudentWorld* myWorld, int imageID, int hitPoints) : Actor(myWorld, imageID, 60, 60, left, 1.0, 0){
+Protestor::Protestor(StudentWorld* myWorld, ActorKind kind, int imageID, int hitPoints) : Actor(myWorld, kind, imageID, myWorld->getFieldWidth() - actorSize, myWorld->getFieldHeight() - actorSize, left, 1.0, 0){
     
     setVisible(true); //Protestors always start out as visible
     
     m_hitPoints = hitPoints;
     m_numSquaresToMoveInCurrentDirection = generateNumSquaresToMove();
-    m_tickCount = 1000; //So that the protestor will do something on the first tick
     m_nonRestingTicksSinceShout = 1000; //So that the protestor will shout at the first opportunity
     m_nonRestingTicksSinceTurn = 0;
     m_leaveTheOilField = false;
+    setBehavior(behave()); //The protestor acts on its very first turn
 
 }
 
 void Protestor::doSomething(){
    if(!getLiveStatus())
        return;
-    
-    if(m_leaveTheOilField){
-        if(getX() == 60 && getY() == 60){
-            setLiveStatus(false);
+    resumeBehavior();
+}
+
+ActorTask Protestor::behave(){
+    while(!m_leaveTheOilField){
+        int ticksToWaitBetweenMoves = getWorld()->getLevelParams().protestorRestTicks;
+        
+        //Far from the TunnelMan with AI level of detail on, the protestor doesn't look for him; it makes stride wandering
+        //moves in one turn, then rests through the stride rest-and-move cycles they stand for, which keeps its average speed
+        int stride = getWorld()->protestorUpdateStride(this);
+        if(stride > 1){
+            for(int step = 0; step < stride; step++)
+                wander();
+            co_await ticks(stride * (ticksToWaitBetweenMoves + 1));
+            continue;
         }
-        else{
-            changeDirectionToExit();
-            move();
+        
+        if(withinShoutingDistanceAndFacingTunnelMan()){
+            if(m_nonRestingTicksSinceShout >= 15){
+                getWorld()->getTunnelMan()->annoy(2);
+                getWorld()->playSound(SOUND_PROTESTER_YELL);
+                m_nonRestingTicksSinceShout = 0;
+            }
+            else{
+                m_nonRestingTicksSinceShout++;
+            }
+            m_nonRestingTicksSinceTurn++;
         }
-        return;
-    }
-    
-    //TODO: Fix this
-    int ticksToWaitBetweenMoves = fmax(0, 3 - (getWorld()->getLevel()/4));
-    if(m_tickCount < ticksToWaitBetweenMoves){
-        m_tickCount++;
-        return;
-    }
-    
-    m_tickCount = 0;
-    
-    if(withinShoutingDistanceAndFacingTunnelMan()){
-        if(m_nonRestingTicksSinceShout >= 15){
-            getWorld()->getTunnelMan()->annoy(2);
-            getWorld()->playSound(SOUND_PROTESTER_YELL);
-            m_nonRestingTicksSinceShout = 0;
+        else if(getWorld()->protestorIntentFor(this).canReachTunnelMan){
+            Direction dOld = getDirection();
+            changeDirectionToMoveTowardTunnelMan();
+            Direction dNew = getDirection();
+            if(justTurned90(dOld, dNew))
+                m_nonRestingTicksSinceTurn = -1;
+
+            m_numSquaresToMoveInCurrentDirection = 0;
+            move();
+            
+            m_nonRestingTicksSinceTurn++;
+            m_nonRestingTicksSinceShout++;
         }
         else{
-            m_nonRestingTicksSinceShout++;
+            //The protestor must continue to move around the oil field randomly:
+            wander();
         }
-        m_nonRestingTicksSinceTurn++;
-        return;
+        
+        //Sleep through the rest; only being annoyed or bribed can cut it short
+        co_await ticks(ticksToWaitBetweenMoves + 1);
     }
     
-    
-    if(canMoveTowardTunnelMan()){
-        Direction dOld = getDirection();
-        changeDirectionToMoveTowardTunnelMan();
-        Direction dNew = getDirection();
-        if(justTurned90(dOld, dNew))
-            m_nonRestingTicksSinceTurn = -1;
-
-        m_numSquaresToMoveInCurrentDirection = 0;
+    while(getX() != getWorld()->getFieldWidth() - actorSize || getY() != getWorld()->getFieldHeight() - actorSize){
+        changeDirectionToExit();
         move();
-        
-        m_nonRestingTicksSinceTurn++;
-        m_nonRestingTicksSinceShout++;
-        return;
+        co_await ticks(1);
     }
-    
-    
-    //The protestor must continue to move around the oil field randomly:
+    setLiveStatus(false);
+}
+
+void Protestor::wander(){
     m_numSquaresToMoveInCurrentDirection--;
     if(m_numSquaresToMoveInCurrentDirection <= 0){
         Direction oldD = getDirection();
@@ -562,12 +689,13 @@ void Protestor::annoy(int howMuch){
     m_hitPoints -= howMuch;
     if(m_hitPoints <= 0){
         getWorld()->playSound(SOUND_PROTESTER_GIVE_UP);
+        interrupt(0); //Head for the exit on the next turn
         m_leaveTheOilField = true;
         if(howMuch == squirtDamage){
-            if(getGameID() == 'p'){
+            if(getKind() == kindRegularProtestor){
                 getWorld()->increaseScore(100);
             }
-            else if(getGameID() == 'P'){
+            else if(getKind() == kindHardcoreProtestor){
                 getWorld()->increaseScore(250);
             }
         }
@@ -576,26 +704,71 @@ void Protestor::annoy(int howMuch){
         return;
     }
     
-    //TODO: Fix
-    m_tickCount = fmax(0, 3 - (getWorld()->getLevel()/4)) - fmax(50, 100 - getWorld()->getLevel()*10);
+    //A stunned protestor stays put for protestorStunTicks turns, whatever was left of its rest
+    if(!m_leaveTheOilField)
+        interrupt(getWorld()->getLevelParams().protestorStunTicks);
 }
 
 void Protestor::bribe(){
     getWorld()->playSound(SOUND_PROTESTER_FOUND_GOLD);
     
-    if(getGameID() == 'P'){
+    if(getKind() == kindHardcoreProtestor){
         getWorld()->increaseScore(50);
        
-        //TODO: Fix
-        m_tickCount = fmax(50, 100 - getWorld()->getLevel()*10);
+        //Staring at the gold counts as protestorStunTicks of the protestor's rest
+        const LevelParams& params = getWorld()->getLevelParams();
+        if(!m_leaveTheOilField)
+            interrupt(max(params.protestorRestTicks - params.protestorStunTicks, 0));
     }
     else{
         getWorld()->increaseScore(25);
+        interrupt(0);
         m_leaveTheOilField = true;
     }
     
 }
 
+bool Protestor::isLeavingOilField() const{
+    return m_leaveTheOilField;
+}
+
+bool Protestor::willActThisTick() const{
+    return !isSuspended();
+}
+
+int Protestor::restTicksCounted() const{
+    //A protestor that isn't sleeping on the timing wheel is done resting
+    if(!isScheduled())
+        return getWorld()->getLevelParams().protestorRestTicks;
+    //Each turn slept through counts one tick
+    return getWorld()->getLevelParams().protestorRestTicks - turnsToSleep();
+}
+
+void Protestor::saveState(ActorRecord& r) const{
+    Actor::saveState(r);
+    r.state[0] = m_hitPoints;
+    r.state[1] = m_numSquaresToMoveInCurrentDirection;
+    r.state[2] = restTicksCounted();
+    r.state[3] = m_nonRestingTicksSinceTurn;
+    r.state[4] = m_nonRestingTicksSinceShout;
+    r.state[5] = m_leaveTheOilField;
+}
+
+void Protestor::restoreState(const ActorRecord& r){
+    Actor::restoreState(r);
+    m_hitPoints = r.state[0];
+    m_numSquaresToMoveInCurrentDirection = r.state[1];
+    m_nonRestingTicksSinceTurn = r.state[3];
+    m_nonRestingTicksSinceShout = r.state[4];
+    m_leaveTheOilField = r.state[5] != 0;
+    
+    //Sleep through the rest of the rest; the behavior acts as soon as it's over
+    int restTicks = getWorld()->getLevelParams().protestorRestTicks;
+    int ticksRested = r.state[2];
+    if(!m_leaveTheOilField && ticksRested < restTicks)
+        suspendFor(restTicks - ticksRested + 1);
+}
+
 //Private Functions
 int Protestor::generateNumSquaresToMove(){
     return rand() % 53 + 8;
@@ -674,7 +847,20 @@ GraphObject::Direction Protestor::generateRandomDirection(){
         return right;
         
 }
-bool Protestor::canMoveTowardTunnelMan(){
+void Protestor::decideIntent(ProtestorIntent& intent) const{
+    intent.valid = false;
+    if(intent.leaving){
+        const MazeField* field = getWorld()->freshMazeFieldTo(getWorld()->getFieldWidth() - actorSize, getWorld()->getFieldHeight() - actorSize);
+        if(field == nullptr)
+            return;
+        intent.exitDirection = getWorld()->getDirectionOnField(*field, getX(), getY());
+    }
+    else
+        intent.canReachTunnelMan = hasClearLineToTunnelMan();
+    intent.valid = true;
+}
+
+bool Protestor::hasClearLineToTunnelMan() const{
     int x = getX();
     int y = getY();
     int tX = getWorld()->getTunnelMan()->getX();
@@ -716,18 +902,14 @@ bool Protestor::canMoveTowardTunnelMan(){
 
 
 void Protestor::changeDirectionToExit(){
-    setDirection(getWorld()->getDirectionToLocation(this, 60, 60));
+    setDirection(getWorld()->protestorIntentFor(this).exitDirection);
 }
 
 
 
 /*                            RegularProtestor Class Function Implementations           */
 
-RegularProtestor::RegularProtestor(StudentWorld* myWorld) : Protestor(myWorld, TID_PROTESTER, 5){}
-
-char RegularProtestor::getGameID() const{
-    return 'p';
-}
+RegularProtestor::RegularProtestor(StudentWorld* myWorld) : Protestor(myWorld, kindRegularProtestor, TID_PROTESTER, 5){}
 
 
 
@@ -759,19 +941,26 @@ void RegularProtestor::faceTunnelMan(){
 
 
 /*                              HardcoreProtestor Class Implementation                          */
-HardcoreProtestor::HardcoreProtestor(StudentWorld* myWorld) : Protestor(myWorld, TID_HARD_CORE_PROTESTER, 20){}
-
-char HardcoreProtestor::getGameID() const{
-    return 'P';
-}
+HardcoreProtestor::HardcoreProtestor(StudentWorld* myWorld) : Protestor(myWorld, kindHardcoreProtestor, TID_HARD_CORE_PROTESTER, 20){}
 
-bool HardcoreProtestor::canMoveTowardTunnelMan(){
-    int maxMovesToTunnelMan = 16 + getWorld()->getLevel()*2;
-    return Protestor::canMoveTowardTunnelMan() || getWorld()->isXMovesAwayFromTunnelMan(this, maxMovesToTunnelMan);
+void HardcoreProtestor::decideIntent(ProtestorIntent& intent) const{
+    Protestor::decideIntent(intent);
+    if(!intent.valid || intent.leaving)
+        return;
+    
+    const MazeField* field = getWorld()->freshMazeFieldTo(intent.playerX, intent.playerY);
+    if(field == nullptr){
+        intent.valid = false;
+        return;
+    }
+    int maxMovesToTunnelMan = getWorld()->getLevelParams().hardcoreTrackingMoves;
+    if(!intent.canReachTunnelMan)
+        intent.canReachTunnelMan = getWorld()->isWithinMovesOnField(*field, getX(), getY(), maxMovesToTunnelMan);
+    intent.chaseDirection = getWorld()->getDirectionOnField(*field, getX(), getY());
 }
 
 void HardcoreProtestor::changeDirectionToMoveTowardTunnelMan(){
-    setDirection(getWorld()->getDirectionToLocation(this, getWorld()->getTunnelMan()->getX(), getWorld()->getTunnelMan()->getY())); 
+    setDirection(getWorld()->protestorIntentFor(this).chaseDirection);
 }
 
 
@@ -2,20 +2,127 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "WorldSnapshot.h"
+#include "TimingWheel.h"
+#include "ActorTask.h"
 
 class StudentWorld;
+struct ProtestorIntent;
+
+//Every concrete kind of actor. StudentWorld's tick loop switches on it to call each kind's doSomething directly, and
+//keeps the actors of each category in their own list
+enum ActorKind{
+    kindTunnelMan,
+    kindBoulder,
+    kindBarrel,
+    kindWaterPool,
+    kindSonarKit,
+    kindGold,
+    kindSquirt,
+    kindRegularProtestor,
+    kindHardcoreProtestor
+};
+
+//World events an actor can suspend itself until (see Actor::suspendUntil)
+enum WorldEvent{
+    eventNone,
+    eventGroundOpenedBelow //the 4x1 strip under the actor was dug out or vacated
+};
 
 //A base class for all the games Objects
 class Actor : public GraphObject{
 public:
-    Actor(StudentWorld* myWorld, int imageID, int startX, int startY, Direction dir = right, double size = 1.0, unsigned int depth = 0);
+    Actor(StudentWorld* myWorld, ActorKind kind, int imageID, int startX, int startY, Direction dir = right, double size = 1.0, unsigned int depth = 0);
     
     void setLiveStatus(bool b);
     bool getLiveStatus() const;
     
     StudentWorld* getWorld() const;
     
-    virtual char getGameID() const = 0;
+    ActorKind getKind() const{
+        return m_kind;
+    }
+    bool isProtestor() const{
+        return m_kind == kindRegularProtestor || m_kind == kindHardcoreProtestor;
+    }
+    bool isGoodie() const{
+        return m_kind >= kindBarrel && m_kind <= kindGold;
+    }
+    //The character snapshots identify the actor's kind by
+    char getGameID() const;
+    
+    //Where StudentWorld keeps the actor in its category's list; only the world uses it
+    int getListIndex() const{
+        return m_listIndex;
+    }
+    void setListIndex(int i){
+        m_listIndex = i;
+    }
+    //Where the actor is in the world's update order (-1 for the TunnelMan and actors not added yet); only the world uses it
+    int getUpdateIndex() const{
+        return m_updateIndex;
+    }
+    void setUpdateIndex(int i){
+        m_updateIndex = i;
+    }
+    
+    //An actor with nothing to do until some ticks have gone by or a world event happens suspends itself, and the world
+    //skips its turns until then. A wait for ticks sits on the world's timing wheel and ends with a wakeUp() call at the
+    //start of the tick it's due; a wait for an event ends when the world signals the event to the actor
+    void suspendFor(int ticks);
+    void suspendUntil(WorldEvent e);
+    //Cuts any wait short, without a wakeUp() call: the actor's next turn comes after it skips turnsToSkip more of them
+    void interrupt(int turnsToSkip);
+    //Called by the world when an event happens to the actor; resumes it if it was waiting for that event
+    void signal(WorldEvent e);
+    bool isSuspended() const{
+        return m_awaitedEvent != eventNone || isScheduled();
+    }
+    //Returns whether the actor is waiting for ticks to go by
+    bool isScheduled() const;
+    //Returns how many more turns a scheduled actor will skip before its turn in the tick it's woken at
+    int turnsToSleep() const;
+    TimerNode& getTimer();
+    virtual void wakeUp(){}
+    
+    //What a behavior coroutine co_awaits to let n of the actor's turns go by (co_await ticks(1) carries on in its next
+    //turn, and anything less doesn't wait at all) or to wait for the world to signal an event to it
+    struct TicksAwaiter{
+        Actor* actor;
+        int turns;
+        bool await_ready() const noexcept{
+            return turns <= 0;
+        }
+        void await_suspend(std::coroutine_handle<>){
+            if(turns > 1)
+                actor->suspendFor(turns);
+        }
+        void await_resume() const noexcept{}
+    };
+    struct EventAwaiter{
+        Actor* actor;
+        WorldEvent event;
+        bool await_ready() const noexcept{
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<>){
+            actor->suspendUntil(event);
+        }
+        void await_resume() const noexcept{}
+    };
+    TicksAwaiter ticks(int n){
+        return TicksAwaiter{this, n};
+    }
+    EventAwaiter worldEvent(WorldEvent e){
+        return EventAwaiter{this, e};
+    }
+    
+    //Runs the actor's behavior coroutine, if it has one, on to its next co_await. The world calls it in the actor's turn,
+    //so a suspended actor's coroutine isn't touched until its wait is over
+    void resumeBehavior(){
+        m_behavior.resume();
+    }
+    
     virtual void doSomething() = 0;
     
     //Default annoy function on an actor does nothing
@@ -26,32 +133,33 @@ public:
     //Move the actor one square in it's current direction if it stays within bounds
     void move();
     
+    //Writes the actor's complete state into a snapshot record
+    virtual void saveState(ActorRecord& r) const;
+    //Restores a state written by saveState
+    virtual void restoreState(const ActorRecord& r);
+    
     virtual ~Actor(){}
     
+protected:
+    //Gives the actor the coroutine it acts through; it first runs in the actor's first turn
+    void setBehavior(ActorTask behavior);
 
 private:
     StudentWorld* m_world;
+    ActorKind m_kind;
+    int m_listIndex;
+    int m_updateIndex;
+    TimerNode m_timer;
+    WorldEvent m_awaitedEvent;
     bool m_isAlive;
+    ActorTask m_behavior;
 };
 
-class Earth : public Actor{
-public:
-    Earth(StudentWorld* myWorld, int startX, int startY);
-    
-    //Earth doesn't do anything
-    virtual void doSomething(){}
-    //Earth has a gameID of 'E'
-    virtual char getGameID() const;
-};
-
-
-
 class TunnelMan : public Actor{
 public:
     TunnelMan(StudentWorld* myWorld);
     
     virtual void doSomething();
-    virtual char getGameID() const;
     virtual void annoy(int howMuch);
     
     //Getters and Setters
@@ -69,6 +177,9 @@ public:
     int getNumSquirts();
     
     int getHitPoints();
+    
+    virtual void saveState(ActorRecord& r) const;
+    virtual void restoreState(const ActorRecord& r);
 
     virtual ~TunnelMan(){}
     
@@ -86,19 +197,24 @@ private:
 class Boulder : public Actor{
 public:
     Boulder(StudentWorld* myWorld, int startX, int startY);
-    virtual char getGameID() const;
     virtual void doSomething();
+    virtual void saveState(ActorRecord& r) const;
+    virtual void restoreState(const ActorRecord& r);
+    
     virtual ~Boulder(){}
 private:
-    int state; //0 for stable, 1 for waiting, 2 for falling
-    int ticksElapsed;
+    enum Stage{stageStable, stageWaiting, stageFalling};
+    //How far through its life the boulder is; a restored boulder's behavior picks up at the start of this stage
+    Stage m_stage;
+    //Rests on the earth until the ground below opens up, waits, then falls until it lands on something
+    ActorTask behave();
     void smushCharacters();
     bool boulderCanFall() const;
 };
 
 class Goodie : public Actor{
 public:
-    Goodie(StudentWorld* myWorld, int imageID, int startX, int startY, bool tunnelManCanPickUp, bool temp);
+    Goodie(StudentWorld* myWorld, ActorKind kind, int imageID, int startX, int startY, bool tunnelManCanPickUp, bool temp);
     
     virtual void doSomething();
     
@@ -106,11 +222,25 @@ public:
     virtual void doSomethingToProtestor(){}
     
     void setTickLifeTime(int tickLifeTime);
+    
+    //Goodies that stay until they're picked up only do anything when the TunnelMan comes within goodieRevealRadius of
+    //them, so they skip their turns unless the world has triggered them for the tick
+    bool isTemporary() const;
+    bool canBePickedUp() const;
+    bool isTriggered() const;
+    void setTriggered(bool b);
+    
+    //Temporary goodies the TunnelMan can pick up sleep out their lifetime on the timing wheel; this ends it
+    virtual void wakeUp();
+    
+    virtual void saveState(ActorRecord& r) const;
+    virtual void restoreState(const ActorRecord& r);
     virtual ~Goodie(){}
     
 private:
     bool m_tunnelManCanPickUp;
     bool m_temporary;
+    bool m_triggered;
     int m_tickLifeTime;
     int m_tickCount;
 };
@@ -118,28 +248,24 @@ private:
 class Barrel : public Goodie{
 public:
     Barrel(StudentWorld* myWorld, int startX, int startY);
-    virtual char getGameID() const;
     virtual void doSomethingToTunnelMan();
 };
 
 class WaterPool : public Goodie{
 public:
     WaterPool(StudentWorld* myWorld, int startX, int startY);
-    virtual char getGameID() const;
     virtual void doSomethingToTunnelMan();
 };
 
 class SonarKit : public Goodie{
 public:
     SonarKit(StudentWorld* myWorld);
-    virtual char getGameID() const;
     virtual void doSomethingToTunnelMan();
 };
 
 class Gold: public Goodie{
 public:
     Gold(StudentWorld* myWorld, int startX, int startY, bool tunnelManCanPickUp);
-    virtual char getGameID() const;
     virtual void doSomethingToTunnelMan();
     virtual void doSomethingToProtestor();
 };
@@ -148,10 +274,12 @@ public:
 class Squirt : public Actor{
 public:
     Squirt(StudentWorld* myWorld, int startX, int startY);
-    virtual char getGameID() const;
     
     virtual void doSomething();
     
+    virtual void saveState(ActorRecord& r) const;
+    virtual void restoreState(const ActorRecord& r);
+    
 private:
     int m_travelDistance;
 };
@@ -159,16 +287,28 @@ private:
 
 class Protestor : public Actor{
 public:
-    Protestor(StudentWorld* myWorld, int imageID, int hitPoints);
+    Protestor(StudentWorld* myWorld, ActorKind kind, int imageID, int hitPoints);
     
     virtual void doSomething();
     
     virtual void bribe();
-    virtual bool canMoveTowardTunnelMan();
     virtual void changeDirectionToMoveTowardTunnelMan() = 0;
     
+    //Decides the parts of the protestor's next turn that only look at the world (the way out, and whether and which way
+    //it can head for the TunnelMan). Changes nothing, so the world runs it for every protestor at once on its worker
+    //threads; the intent's leaving flag and position are filled in already
+    virtual void decideIntent(ProtestorIntent& intent) const;
+    
     virtual void annoy(int howMuch);
     
+    //Returns whether the protestor has given up and is heading for the exit
+    bool isLeavingOilField() const;
+    //Returns whether the protestor is done resting and will act on its next turn
+    bool willActThisTick() const;
+    
+    virtual void saveState(ActorRecord& r) const;
+    virtual void restoreState(const ActorRecord& r);
+    
     virtual ~Protestor(){}
     
 protected:
@@ -176,6 +316,8 @@ protected:
     int generateNumSquaresToMove();
     //Returns whether the protestor is within shouting distance of the tunnelman, and facing him
     bool withinShoutingDistanceAndFacingTunnelMan();
+    //Returns whether the protestor is in a straight line with the tunnelman with nothing in between
+    bool hasClearLineToTunnelMan() const;
     //Returns whether the protestor just turned 90 degrees
     bool justTurned90(Direction d1, Direction d2);
     //Returns a random direction
@@ -186,22 +328,27 @@ protected:
     bool atIntersection();
     //Changes direction (if needed) so that the protestor is on its way to leave the oil field
     void changeDirectionToExit();
+    //Returns how far through its rest the protestor is, counting the ticks it has slept through on the timing wheel
+    int restTicksCounted() const;
+    //Takes one step of wandering around the oil field at random
+    void wander();
     
 private:
     int m_hitPoints;
     int m_numSquaresToMoveInCurrentDirection;
-    int m_tickCount;
     int m_nonRestingTicksSinceTurn;
     int m_nonRestingTicksSinceShout;
     bool m_leaveTheOilField;
     
+    //Acts once every rest until the protestor gives up, then walks it to the exit. Every co_await ends a pass round one of
+    //its loops, so a restored protestor, whose rest (if any) is already back on the timing wheel, starts from the top
+    ActorTask behave();
 };
 
 
 class RegularProtestor : public Protestor{
 public:
     RegularProtestor(StudentWorld* myWorld);
-    virtual char getGameID() const;
     virtual void changeDirectionToMoveTowardTunnelMan();
     
     
@@ -213,9 +360,9 @@ private:
 class HardcoreProtestor : public Protestor{
 public:
     HardcoreProtestor(StudentWorld* myWorld);
-    virtual char getGameID() const;
-    virtual bool canMoveTowardTunnelMan();
     virtual void changeDirectionToMoveTowardTunnelMan();
+    //Also lets the protestor head for the TunnelMan when he's within tracking range through the tunnels
+    virtual void decideIntent(ProtestorIntent& intent) const;
 
     
 private:
@@ -0,0 +1,66 @@
+#include "ActorReclaimer.h"
+#include "Actor.h"
+
+using namespace std;
+
+ActorReclaimer::ActorReclaimer(){
+    m_busy = false;
+    m_stopping = false;
+    m_thread = thread(&ActorReclaimer::run, this);
+}
+
+ActorReclaimer::~ActorReclaimer(){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_one();
+    m_thread.join();
+}
+
+void ActorReclaimer::retire(const vector<Actor*>& actors){
+    if(actors.empty())
+        return;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_batches.emplace_back();
+        if(!m_spareBatches.empty()){
+            m_batches.back().swap(m_spareBatches.back());
+            m_spareBatches.pop_back();
+        }
+        m_batches.back().assign(actors.begin(), actors.end());
+    }
+    m_wakeUp.notify_one();
+}
+
+void ActorReclaimer::waitUntilIdle(){
+    unique_lock<mutex> lock(m_mutex);
+    m_idle.wait(lock, [this](){ return m_batches.empty() && !m_busy; });
+}
+
+void ActorReclaimer::run(){
+    unique_lock<mutex> lock(m_mutex);
+    while(true){
+        m_wakeUp.wait(lock, [this](){ return m_stopping || !m_batches.empty(); });
+        if(m_batches.empty()){
+            //Only stop once everything handed over has been deleted
+            return;
+        }
+        
+        vector<Actor*> batch;
+        batch.swap(m_batches.front());
+        m_batches.pop_front();
+        m_busy = true;
+        lock.unlock();
+        
+        for(size_t i = 0; i < batch.size(); i++)
+            delete batch[i];
+        
+        batch.clear();
+        lock.lock();
+        m_spareBatches.push_back(std::move(batch));
+        m_busy = false;
+        if(m_batches.empty())
+            m_idle.notify_all();
+    }
+}
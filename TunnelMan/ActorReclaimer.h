@@ -0,0 +1,45 @@
+#ifndef ACTORRECLAIMER_H_
+#define ACTORRECLAIMER_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Actor;
+
+//Deletes retired actors on a background thread, so tearing down a level doesn't stall the game thread on thousands of
+//destructors and GraphObject registry updates. Actors handed over must already be hidden and must no longer be
+//reachable from the world
+class ActorReclaimer{
+public:
+    ActorReclaimer();
+    //Deletes anything still waiting, then stops the thread
+    ~ActorReclaimer();
+    
+    //Takes ownership of every actor in the list. Only the pointers are copied (into a buffer kept from an earlier batch),
+    //so the caller can clear the list and keep its storage
+    void retire(const std::vector<Actor*>& actors);
+    
+    //Blocks until every actor retired so far has been deleted
+    void waitUntilIdle();
+    
+private:
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_idle;
+    std::deque<std::vector<Actor*>> m_batches;
+    std::vector<std::vector<Actor*>> m_spareBatches; //emptied batches, kept for their storage
+    bool m_busy;
+    bool m_stopping;
+    
+    void run();
+    
+    //Prevent copying or assigning ActorReclaimers
+    ActorReclaimer(const ActorReclaimer&);
+    ActorReclaimer& operator=(const ActorReclaimer&);
+};
+
+#endif // ACTORRECLAIMER_H_
@@ -0,0 +1,69 @@
+#ifndef ACTORTASK_H_
+#define ACTORTASK_H_
+
+#include <coroutine>
+#include <exception>
+
+//An actor's behavior, written as a C++20 coroutine that co_awaits the turns or world events it waits for (see
+//Actor::ticks and Actor::worldEvent). It starts suspended, and each resume() runs it on to its next co_await. The task owns
+//the coroutine and destroys it with itself
+class ActorTask{
+public:
+    struct promise_type{
+        ActorTask get_return_object(){
+            return ActorTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept{
+            return std::suspend_always();
+        }
+        //Stay suspended at the end, so the task can still tell the behavior has finished
+        std::suspend_always final_suspend() noexcept{
+            return std::suspend_always();
+        }
+        void return_void(){}
+        //A behavior has nowhere to report an error to
+        void unhandled_exception(){
+            std::terminate();
+        }
+    };
+
+    ActorTask(){
+        m_handle = nullptr;
+    }
+    ActorTask(ActorTask&& other) noexcept{
+        m_handle = other.m_handle;
+        other.m_handle = nullptr;
+    }
+    ActorTask& operator=(ActorTask&& other) noexcept{
+        if(this != &other){
+            if(m_handle)
+                m_handle.destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    ~ActorTask(){
+        if(m_handle)
+            m_handle.destroy();
+    }
+
+    //Runs the behavior on to its next co_await; does nothing once it has finished
+    void resume(){
+        if(m_handle && !m_handle.done())
+            m_handle.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+
+    explicit ActorTask(std::coroutine_handle<promise_type> handle){
+        m_handle = handle;
+    }
+
+    //Prevent copying or assigning ActorTasks
+    ActorTask(const ActorTask&);
+    ActorTask& operator=(const ActorTask&);
+};
+
+#endif // ACTORTASK_H_
@@ -0,0 +1,128 @@
+#include "EarthField.h"
+
+using namespace std;
+
+EarthField::EarthField(){
+    m_width = 0;
+    m_height = 0;
+    m_chunksWide = 0;
+    m_chunksHigh = 0;
+}
+
+void EarthField::resize(int width, int height){
+    m_width = width;
+    m_height = height;
+    m_chunksWide = (width + chunkSize - 1) / chunkSize;
+    m_chunksHigh = (height + chunkSize - 1) / chunkSize;
+    releaseAll();
+    m_chunks.assign(static_cast<size_t>(m_chunksWide) * m_chunksHigh, emptyChunk);
+}
+
+void EarthField::reset(){
+    releaseAll();
+    fill(m_chunks.begin(), m_chunks.end(), solidChunk);
+
+    int shaftLeft = m_width / 2 - 2;
+    clearRect(0, m_height - squareSize, m_width, m_height);
+    clearRect(shaftLeft, squareSize, shaftLeft + squareSize, m_height);
+}
+
+void EarthField::clearRect(int left, int bottom, int right, int top){
+    left = max(left, 0);
+    right = min(right, m_width);
+    bottom = max(bottom, 0);
+    top = min(top, m_height);
+    if(left >= right)
+        return;
+
+    for(int y = bottom; y < top; y++){
+        for(int cx = left / chunkSize; cx <= (right - 1) / chunkSize; cx++){
+            int32_t& chunk = m_chunks[(y / chunkSize) * m_chunksWide + cx];
+            if(chunk == emptyChunk)
+                continue;
+            if(chunk == solidChunk)
+                chunk = materializeSolidChunk(cx, y / chunkSize);
+
+            uint64_t* bits = &m_bitsets[static_cast<size_t>(chunk) * chunkSize];
+            bits[y % chunkSize] &= ~spanMask(cx, left, right);
+
+            //Give the bitset back once the chunk has been dug out completely
+            if(bits[y % chunkSize] == 0 && all_of(bits, bits + chunkSize, [](uint64_t w){ return w == 0; })){
+                m_freeBitsets.push_back(chunk);
+                chunk = emptyChunk;
+            }
+        }
+    }
+}
+
+size_t EarthField::numWords() const{
+    return static_cast<size_t>(m_height) * m_chunksWide;
+}
+
+void EarthField::copyWords(uint64_t* words) const{
+    for(int y = 0; y < m_height; y++){
+        for(int cx = 0; cx < m_chunksWide; cx++)
+            *words++ = rowBits(cx, y) & spanMask(cx, 0, m_width);
+    }
+}
+
+void EarthField::setWords(const uint64_t* words){
+    releaseAll();
+    for(int cy = 0; cy < m_chunksHigh; cy++){
+        int rows = min(chunkSize, m_height - cy * chunkSize);
+        for(int cx = 0; cx < m_chunksWide; cx++){
+            uint64_t inField = spanMask(cx, 0, m_width);
+            const uint64_t* column = words + static_cast<size_t>(cy) * chunkSize * m_chunksWide + cx;
+
+            bool empty = true;
+            bool solid = true;
+            for(int r = 0; r < rows; r++){
+                uint64_t w = column[static_cast<size_t>(r) * m_chunksWide] & inField;
+                empty = empty && w == 0;
+                solid = solid && w == inField;
+            }
+
+            int32_t& chunk = m_chunks[cy * m_chunksWide + cx];
+            if(empty)
+                chunk = emptyChunk;
+            else if(solid)
+                chunk = solidChunk;
+            else{
+                chunk = allocateBitset();
+                uint64_t* bits = &m_bitsets[static_cast<size_t>(chunk) * chunkSize];
+                for(int r = 0; r < rows; r++)
+                    bits[r] = column[static_cast<size_t>(r) * m_chunksWide] & inField;
+            }
+        }
+    }
+}
+
+int32_t EarthField::allocateBitset(){
+    int32_t index;
+    if(!m_freeBitsets.empty()){
+        index = m_freeBitsets.back();
+        m_freeBitsets.pop_back();
+    }
+    else{
+        index = static_cast<int32_t>(m_bitsets.size() / chunkSize);
+        m_bitsets.resize(m_bitsets.size() + chunkSize);
+    }
+    std::fill(m_bitsets.begin() + static_cast<size_t>(index) * chunkSize, m_bitsets.begin() + static_cast<size_t>(index + 1) * chunkSize, 0);
+    return index;
+}
+
+int32_t EarthField::materializeSolidChunk(int cx, int cy){
+    int32_t index = allocateBitset();
+    uint64_t* bits = &m_bitsets[static_cast<size_t>(index) * chunkSize];
+    int rows = min(chunkSize, m_height - cy * chunkSize);
+    std::fill(bits, bits + rows, spanMask(cx, 0, m_width));
+    return index;
+}
+
+void EarthField::releaseAll(){
+    //Keeps the bitset storage around for the next level; it is handed out again through the free list
+    m_freeBitsets.clear();
+    for(int32_t i = static_cast<int32_t>(m_bitsets.size() / chunkSize) - 1; i >= 0; i--)
+        m_freeBitsets.push_back(i);
+    fill(m_chunks.begin(), m_chunks.end(), emptyChunk);
+}
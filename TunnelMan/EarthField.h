@@ -0,0 +1,118 @@
+#ifndef EARTHFIELD_H_
+#define EARTHFIELD_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+//A field can be anywhere from one screen (VIEW_WIDTH x VIEW_HEIGHT) up to this many cells on a side
+const int maxFieldSize = 4096;
+
+inline bool isValidFieldSize(int width, int height){
+    return width >= VIEW_WIDTH && height >= VIEW_HEIGHT && width <= maxFieldSize && height <= maxFieldSize;
+}
+
+//The oil field's earth, stored as 64x64 chunks. A chunk that is all earth or all dug out is just a marker; only chunks
+//that are partly dug get a 64-word bitset (bit x%64 of word y%64 is set when there is earth at (x, y)). Memory grows
+//with how much of the field has been dug rather than with its area, and resetting the field for a new level just
+//marks every chunk solid again
+class EarthField{
+public:
+    EarthField();
+
+    //Makes the field the given size with no earth in it
+    void resize(int width, int height);
+
+    int width() const{
+        return m_width;
+    }
+
+    int height() const{
+        return m_height;
+    }
+
+    //Fills every row but the top four (where the TunnelMan starts) with earth, except for the 4-wide central shaft from row 4 up
+    void reset();
+
+    bool cellAt(int x, int y) const{
+        if(x < 0 || x >= m_width || y < 0 || y >= m_height)
+            return false;
+        return (rowBits(x / chunkSize, y) >> (x % chunkSize)) & 1;
+    }
+
+    //returns whether any cell of the 4x4 square with its bottom left corner at (x, y) has earth. Cells outside the field don't count
+    bool anyInSquare(int x, int y) const{
+        int left = std::max(x, 0);
+        int right = std::min(x + squareSize, m_width);
+        if(left >= right)
+            return false;
+        for(int row = std::max(y, 0); row < std::min(y + squareSize, m_height); row++){
+            for(int cx = left / chunkSize; cx <= (right - 1) / chunkSize; cx++){
+                if(rowBits(cx, row) & spanMask(cx, left, right))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    //removes the earth from the 4x4 square with its bottom left corner at (x, y), wherever chunk boundaries fall
+    void clearSquare(int x, int y){
+        clearRect(x, y, x + squareSize, y + squareSize);
+    }
+
+    //The word of the plain bitmap below holding columns 64w through 64w+63 of row y
+    uint64_t word(int w, int y) const{
+        return rowBits(w, y) & spanMask(w, 0, m_width);
+    }
+
+    //The earth as a plain bitmap, row after row, each row padded out to whole 64-bit words: the layout snapshots and
+    //level files use
+    size_t numWords() const;
+    void copyWords(uint64_t* words) const;
+    void setWords(const uint64_t* words);
+
+private:
+    static constexpr int squareSize = 4;
+    static constexpr int chunkSize = 64;
+    static constexpr int32_t emptyChunk = -1;
+    static constexpr int32_t solidChunk = -2;
+
+    int m_width;
+    int m_height;
+    int m_chunksWide;
+    int m_chunksHigh;
+    std::vector<int32_t> m_chunks;      //per chunk: emptyChunk, solidChunk or the index of its bitset
+    std::vector<uint64_t> m_bitsets;    //chunkSize words per bitset
+    std::vector<int32_t> m_freeBitsets;
+
+    //the word of chunk column cx holding row y
+    uint64_t rowBits(int cx, int y) const{
+        int32_t chunk = m_chunks[(y / chunkSize) * m_chunksWide + cx];
+        if(chunk == emptyChunk)
+            return 0;
+        if(chunk == solidChunk)
+            return ~uint64_t(0);
+        return m_bitsets[static_cast<size_t>(chunk) * chunkSize + y % chunkSize];
+    }
+
+    //The bits of chunk column cx that stand for columns left through right-1
+    static uint64_t spanMask(int cx, int left, int right){
+        int from = std::max(left - cx * chunkSize, 0);
+        int to = std::min(right - cx * chunkSize, chunkSize);
+        if(from >= to)
+            return 0;
+        uint64_t upTo = to == 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1;
+        return upTo & ~((uint64_t(1) << from) - 1);
+    }
+
+    //removes the earth from columns left through right-1 of rows bottom through top-1
+    void clearRect(int left, int bottom, int right, int top);
+    int32_t allocateBitset();
+    //gives a solid chunk a bitset with every cell of it that lies inside the field set
+    int32_t materializeSolidChunk(int cx, int cy);
+    void releaseAll();
+};
+
+#endif // EARTHFIELD_H_
@@ -0,0 +1,88 @@
+#include "FreeCellIndex.h"
+#include "EarthField.h"
+#include "PackedPositions.h"
+#include <algorithm>
+
+using namespace std;
+
+FreeCellIndex::FreeCellIndex(){
+    m_spotsWide = 0;
+    m_spotsHigh = 0;
+    m_wordsPerRow = 0;
+    m_count = 0;
+}
+
+void FreeCellIndex::rebuild(const EarthField& earth){
+    m_spotsWide = max(earth.width() - squareSize + 1, 0);
+    m_spotsHigh = max(earth.height() - squareSize + 1, 0);
+    m_wordsPerRow = (m_spotsWide + 63) / 64;
+    m_bits.assign(static_cast<size_t>(m_spotsHigh) * m_wordsPerRow, 0);
+    m_rowTree.assign(m_spotsHigh + 1, 0);
+    m_count = 0;
+
+    int earthWords = (earth.width() + 63) / 64;
+    vector<uint64_t> occupied(earthWords + 1, 0); //one spare so the word after the last one reads as empty
+    for(int y = 0; y < m_spotsHigh; y++){
+        //A column is occupied when any of the spot's four rows has earth in it...
+        for(int w = 0; w < earthWords; w++)
+            occupied[w] = earth.word(w, y) | earth.word(w, y + 1) | earth.word(w, y + 2) | earth.word(w, y + 3);
+
+        //...and a spot is free when none of its four columns is
+        int rowCount = 0;
+        for(int w = 0; w < m_wordsPerRow; w++){
+            uint64_t lo = occupied[w];
+            uint64_t hi = occupied[w + 1];
+            uint64_t blocked = lo | (lo >> 1 | hi << 63) | (lo >> 2 | hi << 62) | (lo >> 3 | hi << 61);
+            uint64_t free = ~blocked;
+            int spotsLeft = m_spotsWide - w * 64;
+            if(spotsLeft < 64)
+                free &= (uint64_t(1) << spotsLeft) - 1;
+            m_bits[static_cast<size_t>(y) * m_wordsPerRow + w] = free;
+            rowCount += countBits(free);
+        }
+        m_rowTree[y + 1] = rowCount;
+        m_count += rowCount;
+    }
+
+    //Turn the row counts into a Fenwick tree in place
+    for(int i = 1; i <= m_spotsHigh; i++){
+        int parent = i + (i & -i);
+        if(parent <= m_spotsHigh)
+            m_rowTree[parent] += m_rowTree[i];
+    }
+}
+
+void FreeCellIndex::add(int x, int y){
+    m_bits[static_cast<size_t>(y) * m_wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+    m_count++;
+    for(int i = y + 1; i <= m_spotsHigh; i += i & -i)
+        m_rowTree[i]++;
+}
+
+void FreeCellIndex::nth(size_t k, int& x, int& y) const{
+    //Walk down the Fenwick tree to the row holding the k-th free spot, leaving k as its rank within that row
+    int rowsBelow = 0;
+    int step = 1;
+    while(step * 2 <= m_spotsHigh)
+        step *= 2;
+    for(; step > 0; step /= 2){
+        if(rowsBelow + step <= m_spotsHigh && static_cast<size_t>(m_rowTree[rowsBelow + step]) <= k){
+            rowsBelow += step;
+            k -= m_rowTree[rowsBelow];
+        }
+    }
+    y = rowsBelow;
+
+    const uint64_t* words = &m_bits[static_cast<size_t>(y) * m_wordsPerRow];
+    for(int w = 0; w < m_wordsPerRow; w++){
+        size_t inWord = countBits(words[w]);
+        if(k < inWord){
+            uint64_t word = words[w];
+            for(size_t i = 0; i < k; i++)
+                word &= word - 1;
+            x = w * 64 + lowestBit(word);
+            return;
+        }
+        k -= inWord;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef FREECELLINDEX_H_
+#define FREECELLINDEX_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class EarthField;
+
+//The 4x4 spots of the oil field (named by their bottom left corner) with no earth in them, for placing things at random.
+//Kept as a bit per spot, row after row, with a Fenwick tree over the rows' counts, so the k-th free spot in row-major
+//order is found in O(log height) however little has been dug. Being in a fixed order, rather than the order the spots
+//were freed in, means a world restored from a snapshot picks the same spot for the same random number
+class FreeCellIndex{
+public:
+    FreeCellIndex();
+
+    //Marks exactly the spots of the field with no earth in them as free
+    void rebuild(const EarthField& earth);
+
+    size_t size() const{
+        return m_count;
+    }
+
+    bool contains(int x, int y) const{
+        return (m_bits[static_cast<size_t>(y) * m_wordsPerRow + x / 64] >> (x % 64)) & 1;
+    }
+
+    //Marks a spot as free; it mustn't already be
+    void add(int x, int y);
+
+    //Gets the k-th free spot (counting from 0, row by row from the bottom) for k less than size()
+    void nth(size_t k, int& x, int& y) const;
+
+private:
+    static constexpr int squareSize = 4;
+
+    int m_spotsWide;
+    int m_spotsHigh;
+    int m_wordsPerRow;
+    std::vector<uint64_t> m_bits;   //bit x%64 of word y*m_wordsPerRow + x/64 is set when spot (x, y) is free
+    std::vector<int> m_rowTree;     //Fenwick tree of the number of free spots in each row, indexed from 1
+    size_t m_count;
+};
+
+//returns the number of set bits in a word
+inline int countBits(uint64_t word){
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+#endif // FREECELLINDEX_H_
@@ -10,6 +10,7 @@
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
+#include <random>
 using namespace std;
 
 /*
@@ -48,6 +49,8 @@ static const double FONT_SCALEDOWN = 760.0;
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
+static const double EARTH_CELL_SIZE = 0.25;
+
 static const int MS_PER_FRAME = 1;
 
 static const double PI = 4 * atan(1.0);
@@ -60,8 +63,6 @@ struct SpriteInfo
 };
 
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz);
-static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
 
 void GameController::initDrawersAndSounds()
 {
@@ -120,9 +121,9 @@ void GameController::initDrawersAndSounds()
 		m_soundMap[sounds[k].first] = sounds[k].second;
 }
 
-static void doSomethingCallback()
+static void displayCallback()
 {
-	Game().doSomething();
+	Game().displayEvent();
 }
 
 static void reshapeCallback(int w, int h)
@@ -142,8 +143,34 @@ static void specialKeyboardEventCallback(int key, int x, int y)
 
 static void timerFuncCallback(int val)
 {
-	Game().doSomething();
-	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+	Game().timerEvent();
+}
+
+void GameController::timerEvent()
+{
+	doSomething();
+
+	  // While a prompt is up and nothing has changed, let the timer lapse so
+	  // glutMainLoop sleeps until a key, reshape or expose event wakes us up.
+	if (isIdle())
+		m_timerRunning = false;
+	else
+		glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
+}
+
+void GameController::wakeUp()
+{
+	if (!m_timerRunning)
+	{
+		m_timerRunning = true;
+		glutTimerFunc(0, timerFuncCallback, 0);
+	}
+}
+
+void GameController::displayEvent()
+{
+	m_promptNeedsRedraw = true;
+	doSomething();
 }
 
 void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
@@ -151,8 +178,11 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 	gw->setController(this);
 	m_gw = gw;
 	setGameState(welcome);
-	m_lastKeyHit = INVALID_KEY;
+	m_inputStats = InputLatencyStats();
 	m_singleStep = false;
+	m_ticksPerFrame = MIN_TICKS_PER_FRAME;
+	m_timerRunning = true;
+	m_promptNeedsRedraw = true;
 	m_curIntraFrameTick = 0;
 	m_playerWon = false;
 
@@ -164,11 +194,12 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 	glutCreateWindow(windowTitle.c_str());
 
 	initDrawersAndSounds();
+	m_textRenderer.init();
 
 	glutKeyboardFunc(keyboardEventCallback);
 	glutSpecialFunc(specialKeyboardEventCallback);
 	glutReshapeFunc(reshapeCallback);
-	glutDisplayFunc(doSomethingCallback);
+	glutDisplayFunc(displayCallback);
 	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
@@ -180,28 +211,74 @@ void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
 {
 	switch (key)
 	{
-		case 'a': case '4': m_lastKeyHit = KEY_PRESS_LEFT;	break;
-		case 'd': case '6': m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case 'w': case '8': m_lastKeyHit = KEY_PRESS_UP;	break;
-		case 's': case '2': m_lastKeyHit = KEY_PRESS_DOWN;	break;
-		case 't':			m_lastKeyHit = KEY_PRESS_TAB;	break;
+		case 'a': case '4': keyHit(KEY_PRESS_LEFT);		break;
+		case 'd': case '6': keyHit(KEY_PRESS_RIGHT);	break;
+		case 'w': case '8': keyHit(KEY_PRESS_UP);		break;
+		case 's': case '2': keyHit(KEY_PRESS_DOWN);		break;
+		case 't':			keyHit(KEY_PRESS_TAB);		break;
 		case 'f':			m_singleStep = true;			break;
 		case 'r':			m_singleStep = false;			break;
+		case '+': case '=': setTicksPerFrame(m_ticksPerFrame * 2);	break;
+		case '-': case '_': setTicksPerFrame(m_ticksPerFrame / 2);	break;
 		case 'q': case 'Q': setGameState(quit);				break;
-		default:			m_lastKeyHit = key;				break;
+		default:			keyHit(key);				break;
 	}
+	wakeUp();
 }
 
 void GameController::specialKeyboardEvent(int key, int /* x */, int /* y */)
 {
 	switch (key)
 	{
-		case GLUT_KEY_LEFT:	 m_lastKeyHit = KEY_PRESS_LEFT;	 break;
-		case GLUT_KEY_RIGHT: m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case GLUT_KEY_UP:	 m_lastKeyHit = KEY_PRESS_UP;	 break;
-		case GLUT_KEY_DOWN:	 m_lastKeyHit = KEY_PRESS_DOWN;	 break;
-		default:			 m_lastKeyHit = INVALID_KEY;	 break;
+		case GLUT_KEY_LEFT:	 keyHit(KEY_PRESS_LEFT);	 break;
+		case GLUT_KEY_RIGHT: keyHit(KEY_PRESS_RIGHT); break;
+		case GLUT_KEY_UP:	 keyHit(KEY_PRESS_UP);	 break;
+		case GLUT_KEY_DOWN:	 keyHit(KEY_PRESS_DOWN);	 break;
+		default:			 break;
 	}
+	wakeUp();
+}
+
+void GameController::keyHit(int key)
+{
+	if (!m_keyQueue.push(key))
+		m_inputStats.keysDropped++;
+}
+
+bool GameController::getLastKey(int& value)
+{
+	const InputClock::time_point now = InputClock::now();
+	const InputClock::duration maxLatency = std::chrono::milliseconds(MAX_KEY_LATENCY_MS);
+	bool gotKey = false;
+	KeyEvent event;
+	KeyEvent consumed;
+
+	while (m_keyQueue.pop(event))
+	{
+		if (now - event.timeStamp > maxLatency)
+		{
+			m_inputStats.keysDropped++;		// too stale to act on
+			continue;
+		}
+		if (gotKey)
+			m_inputStats.keysDropped++;		// superseded by a newer key
+		consumed = event;
+		gotKey = true;
+		if (m_keyDrainPolicy == oldestKeyFirst)
+			break;
+	}
+
+	if (!gotKey)
+		return false;
+
+	double latencyMs = std::chrono::duration<double, std::milli>(now - consumed.timeStamp).count();
+	m_inputStats.keysConsumed++;
+	m_inputStats.lastLatencyMs = latencyMs;
+	m_inputStats.maxLatencyMs = std::max(m_inputStats.maxLatencyMs, latencyMs);
+	m_inputStats.totalLatencyMs += latencyMs;
+
+	value = consumed.key;
+	return true;
 }
 
 void GameController::playSound(int soundID)
@@ -245,6 +322,11 @@ void GameController::doSomething()
 			m_nextStateAfterPrompt = cleanup;
 			break;
 		case makemove:
+			if (m_ticksPerFrame > MIN_TICKS_PER_FRAME  &&  !m_singleStep)
+			{
+				runTurboFrame();
+				break;
+			}
 			m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
 			m_nextStateAfterAnimate = not_applicable;
 			{
@@ -293,7 +375,11 @@ void GameController::doSomething()
 			m_nextStateAfterPrompt = quit;
 			break;
 		case prompt:
-			drawPrompt(m_mainMessage, m_secondMessage);
+			if (m_promptNeedsRedraw)
+			{
+				drawPrompt(m_mainMessage, m_secondMessage);
+				m_promptNeedsRedraw = false;
+			}
 			{
 				int key;
 				if (getLastKey(key) && key == '\r')
@@ -321,11 +407,38 @@ void GameController::doSomething()
 			}
 			break;
 		case quit:
+			m_textRenderer.release();
 			glutLeaveMainLoop();
 			break;
 	}
 }
 
+void GameController::setTicksPerFrame(int ticks)
+{
+	m_ticksPerFrame = std::max(MIN_TICKS_PER_FRAME, std::min(ticks, MAX_TICKS_PER_FRAME));
+}
+
+void GameController::runTurboFrame()
+{
+	  // run a batch of ticks back to back, stopping early if the player died or finished the level
+	GameControllerState nextState = makemove;
+	for (int k = 0; k < m_ticksPerFrame  &&  nextState == makemove; k++)
+	{
+		int status = m_gw->move();
+		if (status == GWSTATUS_PLAYER_DIED)
+			nextState = (m_gw->isGameOver() ? gameover : contgame);
+		else if (status == GWSTATUS_FINISHED_LEVEL)
+		{
+			m_gw->advanceToNextLevel();
+			nextState = finishedlevel;
+		}
+	}
+
+	  // no intra-frame animation in turbo mode; just show where everything ended up
+	displayGamePlay(true);
+	setGameState(nextState);
+}
+
 void GameController::drawEarth(double gx, double gy, double gz, double size)
 {
 	glPushMatrix();
@@ -362,13 +475,32 @@ void GameController::drawEarth(double gx, double gy, double gz, double size)
 
 }
 
-void GameController::displayGamePlay()
+void GameController::displayGamePlay(bool skipAnimation)
 {
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
 	glLoadIdentity();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	gluLookAt(0, 0, 0, 0, 0, -1, 0, 1, 0);
 
+	  // only the VIEW_WIDTH x VIEW_HEIGHT window of the field starting at the view origin is drawn
+	int viewX, viewY;
+	m_gw->getViewOrigin(viewX, viewY);
+
+	  // the earth sits behind every layer, so plot it first
+	for (int y = 0; y < VIEW_HEIGHT; y++)
+	{
+		for (int x = 0; x < VIEW_WIDTH; x++)
+		{
+			if (m_gw->hasEarthCell(viewX + x, viewY + y))
+			{
+				double gx, gy, gz;
+				convertToGlutCoords(x, y, gx, gy, gz);
+				drawEarth(gx, gy, gz, EARTH_CELL_SIZE);
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(GraphObject::getGraphObjectsMutex());
 	for (int i = NUM_LAYERS - 1; i >= 0; --i)
 	{
 		std::set<GraphObject*> &graphObjects = GraphObject::getGraphObjects(i);
@@ -378,10 +510,17 @@ void GameController::displayGamePlay()
 			GraphObject* cur = *it;
 			if (cur->isVisible())
 			{
-				cur->animate();
+				if (skipAnimation)
+					cur->jumpToDestination();
+				else
+					cur->animate();
 
 				double x, y, gx, gy, gz;
 				cur->getAnimationLocation(x, y);
+				x -= viewX;
+				y -= viewY;
+				if (x <= -SPRITE_WIDTH  ||  x >= VIEW_WIDTH  ||  y <= -SPRITE_HEIGHT  ||  y >= VIEW_HEIGHT)
+					continue;	// off screen
 				convertToGlutCoords(x, y, gx, gy, gz);
 
 				SpriteManager::Angle angle;
@@ -426,6 +565,8 @@ void GameController::reshape (int w, int h)
 	glLoadIdentity ();
 	gluPerspective(45.0, double(WINDOW_WIDTH) / WINDOW_HEIGHT, PERSPECTIVE_NEAR_PLANE, PERSPECTIVE_FAR_PLANE);
 	glMatrixMode (GL_MODELVIEW);
+	m_promptNeedsRedraw = true;
+	wakeUp();
 }
 
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz)
@@ -437,11 +578,11 @@ static void convertToGlutCoords(double x, double y, double& gx, double& gy, doub
 	gz = .6 * VISIBLE_MIN_Z;
 }
 
-static void doOutputStroke(double x, double y, double z, double size, const char* str, bool centered)
+static void doOutputStroke(const TextRenderer& font, double x, double y, double z, double size, const string& str, bool centered)
 {
 	if (centered)
 	{
-		double len = glutStrokeLength(GLUT_STROKE_ROMAN, reinterpret_cast<const unsigned char*>(str)) / FONT_SCALEDOWN;
+		double len = font.strokeLength(str) / FONT_SCALEDOWN;
 		x = -len / 2;
 		size = 1;
 	}
@@ -451,39 +592,40 @@ static void doOutputStroke(double x, double y, double z, double size, const char
 	glLoadIdentity();
 	glTranslatef(static_cast<GLfloat>(x), static_cast<GLfloat>(y), static_cast<GLfloat>(z));
 	glScalef(scaledSize, scaledSize, scaledSize);
-	for ( ; *str != '\0'; str++)
-		glutStrokeCharacter(GLUT_STROKE_ROMAN, *str);
+	font.draw(str);
 	glPopMatrix();
 }
 
-static void outputStroke(double x, double y, double z, double size, const char* str)
+void GameController::outputStroke(double x, double y, double z, double size, const string& str)
 {
-	doOutputStroke(x, y, z, size, str, false);
+	doOutputStroke(m_textRenderer, x, y, z, size, str, false);
 }
 
-static void outputStrokeCentered(double y, double z, const char* str)
+void GameController::outputStrokeCentered(double y, double z, const string& str)
 {
-	doOutputStroke(0, y, z, 1, str, true);
+	doOutputStroke(m_textRenderer, 0, y, z, 1, str, true);
 }
 
-static void drawPrompt(string mainMessage, string secondMessage)
+void GameController::drawPrompt(const string& mainMessage, const string& secondMessage)
 {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glColor3f (1.0, 1.0, 1.0);
 	glLoadIdentity ();
-	outputStrokeCentered(1, -5, mainMessage.c_str());
-	outputStrokeCentered(-1, -5, secondMessage.c_str());
+	outputStrokeCentered(1, -5, mainMessage);
+	outputStrokeCentered(-1, -5, secondMessage);
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+void GameController::drawScoreAndLives(const string& gameStatText)
 {
 	static int RATE = 1;
+	  // the flicker has its own generator so rendering never perturbs the game's rand() sequence
+	static minstd_rand flicker;
 	static GLfloat rgb[3] =
 		{ static_cast<GLfloat>(.6), static_cast<GLfloat>(.6), static_cast<GLfloat>(.6) };
 	for (int k = 0; k < 3; k++)
 	{
-		double strength = rgb[k] + (-RATE + rand() % (2*RATE+1)) / 100.0;
+		double strength = rgb[k] + (-RATE + static_cast<int>(flicker() % (2*RATE+1))) / 100.0;
 		if (strength < .6)
 			strength = .6;
 		else if (strength > 1.0)
@@ -491,5 +633,5 @@ static void drawScoreAndLives(string gameStatText)
 		rgb[k] = static_cast<GLfloat>(strength);
 	}
 	glColor3f(rgb[0], rgb[1], rgb[2]);
-	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
+	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText);
 }
@@ -2,6 +2,8 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "TextRenderer.h"
+#include "InputQueue.h"
 #include <string>
 #include <map>
 #include <iostream>
@@ -13,34 +15,65 @@ enum GameControllerState {
 
 const int INVALID_KEY = 0;
 
+  // keys that have waited longer than this for a tick to consume them are discarded
+const int MAX_KEY_LATENCY_MS = 250;
+
+enum KeyDrainPolicy {
+	oldestKeyFirst,		// each getLastKey() consumes the oldest queued key
+	newestKeyOnly		// each getLastKey() drains the queue and keeps only the newest key
+};
+
+struct InputLatencyStats
+{
+	unsigned int	keysConsumed;
+	unsigned int	keysDropped;	// overflowed, went stale, or superseded under newestKeyOnly
+	double			lastLatencyMs;	// enqueue-to-consume time of the most recently consumed key
+	double			maxLatencyMs;
+	double			totalLatencyMs;
+};
+
+  // turbo mode runs this many simulation ticks (at most) between rendered frames
+const int MIN_TICKS_PER_FRAME = 1;
+const int MAX_TICKS_PER_FRAME = 1000;
+
 class GraphObject;
 class GameWorld;
 
 class GameController
 {
   public:
+	GameController()
+	 : m_keyDrainPolicy(oldestKeyFirst)
+	{
+	}
+
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
 
-	bool getLastKey(int& value)
+	bool getLastKey(int& value);
+
+	  // takes effect from the next getLastKey(), so it can be set before run()
+	void setKeyDrainPolicy(KeyDrainPolicy policy)
 	{
-		if (m_lastKeyHit != INVALID_KEY)
-		{
-			value = m_lastKeyHit;
-			m_lastKeyHit = INVALID_KEY;
-			return true;
-		}
-		return false;
+		m_keyDrainPolicy = policy;
+	}
+
+	  // what the keys consumed since run() started waited; still valid after run() returns
+	const InputLatencyStats& getInputLatencyStats() const
+	{
+		return m_inputStats;
 	}
 
 	void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	void setGameStatText(const std::string& text)
 	{
 		m_gameStatText = text;
 	}
 
 	void doSomething();
 
+	void timerEvent();
+	void displayEvent();
 	void reshape(int w, int h);
 	void keyboardEvent(unsigned char key, int x, int y);
 	void specialKeyboardEvent(int key, int x, int y);
@@ -62,8 +95,13 @@ private:
 	GameControllerState	m_gameState;
 	GameControllerState	m_nextStateAfterPrompt;
 	GameControllerState	m_nextStateAfterAnimate;
-	int			m_lastKeyHit;
+	InputQueue	m_keyQueue;
+	KeyDrainPolicy m_keyDrainPolicy;
+	InputLatencyStats m_inputStats;
 	bool		m_singleStep;
+	int			m_ticksPerFrame;
+	bool		m_timerRunning;
+	bool		m_promptNeedsRedraw;
 	std::string m_gameStatText;
 	std::string m_mainMessage;
 	std::string m_secondMessage;
@@ -73,16 +111,35 @@ private:
 	SoundMapType m_soundMap;
 	bool		m_playerWon;
 	SpriteManager m_spriteManager;
+	TextRenderer m_textRenderer;
 
 	void setGameState(GameControllerState s)
 	{
 		if (m_gameState != quit)
+		{
 			m_gameState = s;
+			if (s == prompt)
+				m_promptNeedsRedraw = true;
+		}
 	}
 
+	bool isIdle() const
+	{
+		return m_gameState == prompt  &&  !m_promptNeedsRedraw  &&  m_keyQueue.empty();
+	}
+
+	void wakeUp();
+	void keyHit(int key);
+
 	void initDrawersAndSounds();
-	void displayGamePlay();
+	void setTicksPerFrame(int ticks);
+	void runTurboFrame();
+	void displayGamePlay(bool skipAnimation = false);
 	void drawEarth(double gx, double gy, double gz, double size);	// optimized - does not use sprite engine
+	void drawPrompt(const std::string& mainMessage, const std::string& secondMessage);
+	void drawScoreAndLives(const std::string& gameStatText);
+	void outputStroke(double x, double y, double z, double size, const std::string& str);
+	void outputStrokeCentered(double y, double z, const std::string& str);
 };
 
 inline GameController& Game()
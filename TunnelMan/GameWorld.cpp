@@ -6,6 +6,9 @@ using namespace std;
 
 bool GameWorld::getKey(int& value)
 {
+	if (m_controller == nullptr)	// running headless
+		return false;
+
 	bool gotKey = m_controller->getLastKey(value);
 
 	if (gotKey)
@@ -20,10 +23,12 @@ bool GameWorld::getKey(int& value)
 
 void GameWorld::playSound(int soundID)
 {
-	m_controller->playSound(soundID);
+	if (m_controller != nullptr)
+		m_controller->playSound(soundID);
 }
 
-void GameWorld::setGameStatText(string text)
+void GameWorld::setGameStatText(const string& text)
 {
-	m_controller->setGameStatText(text);
+	if (m_controller != nullptr)
+		m_controller->setGameStatText(text);
 }
@@ -26,7 +26,7 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	void setGameStatText(const std::string& text);
 
 	bool getKey(int& value);
 	void playSound(int soundID);
@@ -82,6 +82,29 @@ public:
 	{
 		return m_assetDir;
 	}
+
+	  // the background earth isn't made of GraphObjects; the controller asks the world which cells to plot
+	virtual bool hasEarthCell(int /* x */, int /* y */) const
+	{
+		return false;
+	}
+
+	  // the field position drawn at the bottom left corner of the screen; worlds bigger than the screen move it around
+	virtual void getViewOrigin(int& x, int& y) const
+	{
+		x = 0;
+		y = 0;
+	}
+
+protected:
+
+	  // lets a world put back the stats it saved along with itself
+	void restoreStats(unsigned int level, unsigned int lives, unsigned int score)
+	{
+		m_level = level;
+		m_lives = lives;
+		m_score = score;
+	}
 	
 private:
 	unsigned int	m_lives;
@@ -5,6 +5,7 @@
 #include "GameConstants.h"
 
 #include <set>
+#include <mutex>
 #include <cmath>
 
 const int ANIMATION_POSITIONS_PER_TICK = 1;
@@ -31,11 +32,13 @@ class GraphObject
 		if (m_size <= 0)
 			m_size = 1;
 
+		std::lock_guard<std::mutex> lock(getGraphObjectsMutex());
 		getGraphObjects(m_depth).insert(this);
 	}
 
 	virtual ~GraphObject()
 	{
+		std::lock_guard<std::mutex> lock(getGraphObjectsMutex());
 		getGraphObjects(m_depth).erase(this);
 	}
 
@@ -118,6 +121,12 @@ class GraphObject
 		moveALittle(m_y, m_destY);
 	}
 
+	void jumpToDestination()
+	{
+		m_x = m_destX;
+		m_y = m_destY;
+	}
+
 	static std::set<GraphObject*>& getGraphObjects(unsigned int layer)
 	{
 		static std::set<GraphObject*> graphObjects[NUM_LAYERS];
@@ -127,6 +136,13 @@ class GraphObject
 			return graphObjects[0];		// empty;
 	}
 
+	  // objects may be destroyed off the game thread, so hold this while walking or changing the layers
+	static std::mutex& getGraphObjectsMutex()
+	{
+		static std::mutex graphObjectsMutex;
+		return graphObjectsMutex;
+	}
+
   private:
 	  // Prevent copying or assigning GraphObjects
 	GraphObject(const GraphObject&);
@@ -0,0 +1,188 @@
+#include "InputLog.h"
+#include <iterator>
+#include <algorithm>
+
+using namespace std;
+
+const size_t inputLogFlushSize = 4096;
+
+unsigned int inputLogChecksum(const char* data, size_t size){
+    unsigned int hash = 2166136261u;
+    for(size_t i = 0; i < size; i++){
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+
+/*                          InputLogWriter implementation                   */
+
+InputLogWriter::InputLogWriter(){
+    m_lastTick = 0;
+}
+
+InputLogWriter::~InputLogWriter(){
+    flush();
+}
+
+bool InputLogWriter::open(const string& path, unsigned int seed, const InputLogSetup& setup){
+    m_file.open(path, ios::out | ios::binary | ios::trunc);
+    if(!m_file)
+        return false;
+
+    m_buffer.insert(m_buffer.end(), inputLogMagic, inputLogMagic + sizeof(inputLogMagic));
+    m_buffer.push_back(inputLogVersion);
+    writeVarint(seed);
+    writeVarint((setup.fastRestart ? inputLogFastRestart : 0) | (setup.aiLod ? inputLogAiLod : 0));
+    writeVarint(setup.fieldWidth);
+    writeVarint(setup.fieldHeight);
+    writeVarint(setup.paramsChecksum);
+    writeVarint(setup.levelFileChecksum);
+    writeVarint(static_cast<unsigned int>(setup.startSnapshot.size()));
+    m_buffer.insert(m_buffer.end(), setup.startSnapshot.begin(), setup.startSnapshot.end());
+    m_lastTick = 0;
+    flush();
+    return true;
+}
+
+bool InputLogWriter::isOpen() const{
+    return m_file.is_open();
+}
+
+void InputLogWriter::recordKey(unsigned int tick, int key){
+    if(!isOpen() || key <= 0)
+        return;
+
+    writeVarint(tick - m_lastTick);
+    writeVarint(key);
+    m_lastTick = tick;
+
+    if(m_buffer.size() >= inputLogFlushSize)
+        flush();
+}
+
+void InputLogWriter::finish(const InputLogResults& results){
+    if(!isOpen())
+        return;
+
+    writeVarint(results.finalTick - m_lastTick);
+    writeVarint(0); //end marker
+    writeVarint(results.level);
+    writeVarint(results.lives);
+    writeVarint(results.score);
+    flush();
+    m_file.close();
+}
+
+void InputLogWriter::writeVarint(unsigned int value){
+    while(value >= 0x80){
+        m_buffer.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    m_buffer.push_back(static_cast<unsigned char>(value));
+}
+
+void InputLogWriter::flush(){
+    if(isOpen() && !m_buffer.empty()){
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_file.flush();
+    }
+    m_buffer.clear();
+}
+
+
+
+/*                          InputLogReader implementation                   */
+
+InputLogReader::InputLogReader(){
+    m_pos = 0;
+    m_seed = 0;
+    m_nextKeyTick = 0;
+    m_nextKey = 0;
+    m_results = InputLogResults();
+}
+
+bool InputLogReader::load(const string& path){
+    ifstream file(path, ios::in | ios::binary);
+    if(!file)
+        return false;
+    m_data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+    if(m_data.size() < sizeof(inputLogMagic) + 1 || !equal(inputLogMagic, inputLogMagic + sizeof(inputLogMagic), m_data.begin()))
+        return false;
+    if(m_data[sizeof(inputLogMagic)] != inputLogVersion)
+        return false;
+    m_pos = sizeof(inputLogMagic) + 1;
+    unsigned int flags, snapshotSize;
+    if(!readVarint(m_seed) || !readVarint(flags) || !readVarint(m_setup.fieldWidth) || !readVarint(m_setup.fieldHeight) ||
+       !readVarint(m_setup.paramsChecksum) || !readVarint(m_setup.levelFileChecksum) ||
+       !readVarint(snapshotSize) || snapshotSize > m_data.size() - m_pos)
+        return false;
+    m_setup.fastRestart = (flags & inputLogFastRestart) != 0;
+    m_setup.aiLod = (flags & inputLogAiLod) != 0;
+    m_setup.startSnapshot.assign(m_data.begin() + m_pos, m_data.begin() + m_pos + snapshotSize);
+    m_pos += snapshotSize;
+    size_t firstRecord = m_pos;
+
+    //Walk every record once so a truncated log is rejected up front and the results are known before playback
+    m_nextKeyTick = 0;
+    do{
+        if(!readRecord())
+            return false;
+    }while(m_nextKey != 0);
+
+    m_pos = firstRecord;
+    m_nextKeyTick = 0;
+    return readRecord();
+}
+
+unsigned int InputLogReader::getSeed() const{
+    return m_seed;
+}
+
+const InputLogSetup& InputLogReader::getSetup() const{
+    return m_setup;
+}
+
+const InputLogResults& InputLogReader::getResults() const{
+    return m_results;
+}
+
+bool InputLogReader::nextKey(unsigned int tick, int& key){
+    if(m_nextKey == 0 || m_nextKeyTick != tick)
+        return false;
+
+    key = m_nextKey;
+    if(!readRecord())
+        m_nextKey = 0;
+    return true;
+}
+
+bool InputLogReader::readVarint(unsigned int& value){
+    value = 0;
+    for(int shift = 0; shift < 35; shift += 7){
+        if(m_pos >= m_data.size())
+            return false;
+        unsigned char byte = m_data[m_pos++];
+        value |= static_cast<unsigned int>(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool InputLogReader::readRecord(){
+    unsigned int tickDelta, key;
+    if(!readVarint(tickDelta) || !readVarint(key))
+        return false;
+
+    m_nextKeyTick += tickDelta;
+    m_nextKey = key;
+    if(key == 0){
+        m_results.finalTick = m_nextKeyTick;
+        return readVarint(m_results.level) && readVarint(m_results.lives) && readVarint(m_results.score);
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+#ifndef INPUTLOG_H_
+#define INPUTLOG_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+//An input log records everything a game session needs to be replayed deterministically: the random seed, the settings
+//that change how the world plays out, and every key that getKey() returned, tagged with the tick it was returned on.
+//
+//File layout (all integers are unsigned LEB128 varints):
+//  "TMIL" version seed flags fieldWidth fieldHeight paramsChecksum levelFileChecksum snapshotSize snapshotByte*
+//                              flags bit 0 is fast restart and bit 1 AI level of detail; the checksums are 0 when the
+//                              session had no level settings file or level file; snapshotSize is 0 unless the session
+//                              started from a snapshot
+//  { tickDelta key }*          tickDelta counts ticks since the previous record (or since tick 0); key is never 0
+//  tickDelta 0 level lives score      end marker: the final tick and the results the replay must reproduce
+
+const char inputLogMagic[4] = {'T', 'M', 'I', 'L'};
+//Bumped whenever the format or the way the game draws random numbers changes, so a log that would replay differently
+//is rejected instead
+const unsigned char inputLogVersion = 5;
+
+const unsigned int inputLogFastRestart = 1;
+const unsigned int inputLogAiLod = 2;
+
+//The settings a session started with that change how it plays out, so its replay has to start with them too. The level
+//settings and level files are too big to keep, so only their checksums are, and a replay has to be given the same ones
+struct InputLogSetup{
+    bool fastRestart;
+    bool aiLod;
+    unsigned int fieldWidth;
+    unsigned int fieldHeight;
+    unsigned int paramsChecksum;        //of the level settings the session replaced the standard ones with, or 0
+    unsigned int levelFileChecksum;     //of the level file the session played, or 0
+    std::vector<char> startSnapshot;    //the snapshot image the session started from, or empty
+
+    InputLogSetup() : fastRestart(false), aiLod(false), fieldWidth(0), fieldHeight(0), paramsChecksum(0), levelFileChecksum(0){}
+};
+
+//Returns a checksum (32-bit FNV-1a) of some bytes, for the files a session depended on
+unsigned int inputLogChecksum(const char* data, size_t size);
+
+struct InputLogResults{
+    unsigned int finalTick;
+    unsigned int level;
+    unsigned int lives;
+    unsigned int score;
+};
+
+class InputLogWriter{
+public:
+    InputLogWriter();
+    ~InputLogWriter();
+
+    //Creates the log file and writes its header. Returns false if the file can't be created
+    bool open(const std::string& path, unsigned int seed, const InputLogSetup& setup);
+    bool isOpen() const;
+
+    //Records that getKey() returned key during the given tick
+    void recordKey(unsigned int tick, int key);
+
+    //Writes the end marker and the session's results, then closes the file
+    void finish(const InputLogResults& results);
+
+private:
+    std::ofstream m_file;
+    std::vector<unsigned char> m_buffer;
+    unsigned int m_lastTick;
+
+    void writeVarint(unsigned int value);
+    void flush();
+};
+
+class InputLogReader{
+public:
+    InputLogReader();
+
+    //Loads and validates a whole log. Returns false if it can't be read or is malformed
+    bool load(const std::string& path);
+
+    unsigned int getSeed() const;
+    const InputLogSetup& getSetup() const;
+    const InputLogResults& getResults() const;
+
+    //Returns the next recorded key if it was returned during the given tick
+    bool nextKey(unsigned int tick, int& key);
+
+private:
+    std::vector<unsigned char> m_data;
+    size_t m_pos;
+    unsigned int m_seed;
+    InputLogSetup m_setup;
+    unsigned int m_nextKeyTick;
+    int m_nextKey;
+    InputLogResults m_results;
+
+    bool readVarint(unsigned int& value);
+    bool readRecord();
+};
+
+#endif // INPUTLOG_H_
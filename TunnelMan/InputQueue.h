@@ -0,0 +1,66 @@
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+
+typedef std::chrono::steady_clock InputClock;
+
+struct KeyEvent
+{
+	int						key;
+	InputClock::time_point	timeStamp;
+};
+
+  // Lock-free single-producer/single-consumer ring of timestamped key presses.
+  // The window system's input callbacks push; the game tick pops.
+class InputQueue
+{
+public:
+
+	static const unsigned int CAPACITY = 64;	// must be a power of two
+
+	InputQueue()
+	 : m_head(0), m_tail(0)
+	{
+	}
+
+	  // returns false (and drops the key) if the queue is full
+	bool push(int key)
+	{
+		unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == CAPACITY)
+			return false;
+		m_events[tail & (CAPACITY - 1)].key = key;
+		m_events[tail & (CAPACITY - 1)].timeStamp = InputClock::now();
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(KeyEvent& event)
+	{
+		unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+		event = m_events[head & (CAPACITY - 1)];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+	}
+
+private:
+
+	KeyEvent					m_events[CAPACITY];
+	std::atomic<unsigned int>	m_head;		// next slot to pop; only the consumer writes it
+	std::atomic<unsigned int>	m_tail;		// next slot to push; only the producer writes it
+
+	  // Prevent copying or assigning InputQueues
+	InputQueue(const InputQueue&);
+	InputQueue& operator=(const InputQueue&);
+};
+
+#endif // INPUTQUEUE_H_
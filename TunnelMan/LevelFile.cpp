@@ -0,0 +1,169 @@
+#include "LevelFile.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static size_t levelFileEarthWords(const LevelFileHeader& header){
+    return static_cast<size_t>(header.fieldHeight) * ((header.fieldWidth + 63) / 64);
+}
+
+LevelFile::LevelFile(){
+    m_data = nullptr;
+    m_size = 0;
+}
+
+LevelFile::~LevelFile(){
+    close();
+}
+
+bool LevelFile::open(const string& path){
+    close();
+    
+#if defined(_MSC_VER)
+    ifstream file(path, ios::in | ios::binary);
+    if(!file)
+        return false;
+    m_buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size <= 0){
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); //the mapping stays valid without the descriptor
+    if(mapped == MAP_FAILED)
+        return false;
+    m_data = static_cast<const char*>(mapped);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+    
+    if(!isValid()){
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LevelFile::close(){
+#if !defined(_MSC_VER)
+    if(m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool LevelFile::isOpen() const{
+    return m_data != nullptr;
+}
+
+const char* LevelFile::data() const{
+    return m_data;
+}
+
+size_t LevelFile::size() const{
+    return m_size;
+}
+
+const LevelFileHeader& LevelFile::header() const{
+    return *reinterpret_cast<const LevelFileHeader*>(m_data);
+}
+
+const uint64_t* LevelFile::earthRows() const{
+    return reinterpret_cast<const uint64_t*>(m_data + sizeof(LevelFileHeader));
+}
+
+const LevelPlacement* LevelFile::placements() const{
+    return reinterpret_cast<const LevelPlacement*>(earthRows() + levelFileEarthWords(header()));
+}
+
+void LevelFile::getLayout(int level, LevelLayout& layout) const{
+    layout.level = level;
+    layout.earth.resize(header().fieldWidth, header().fieldHeight);
+    layout.earth.setWords(earthRows());
+    layout.boulders.clear();
+    layout.barrels.clear();
+    layout.nuggets.clear();
+    
+    const LevelPlacement* p = placements();
+    for(uint32_t i = 0; i < header().numPlacements; i++){
+        FieldPosition position = {p[i].x, p[i].y};
+        switch(p[i].gameID){
+            case 'B': layout.boulders.push_back(position); break;
+            case 'O': layout.barrels.push_back(position); break;
+            case 'G': layout.nuggets.push_back(position); break;
+        }
+    }
+}
+
+bool LevelFile::isValid() const{
+    if(m_size < sizeof(LevelFileHeader))
+        return false;
+    const LevelFileHeader& h = header();
+    if(!equal(levelFileMagic, levelFileMagic + sizeof(levelFileMagic), h.magic) || h.version != levelFileVersion)
+        return false;
+    if(h.fieldWidth > static_cast<uint32_t>(maxFieldSize) || h.fieldHeight > static_cast<uint32_t>(maxFieldSize) ||
+       !isValidFieldSize(h.fieldWidth, h.fieldHeight))
+        return false;
+    if(m_size != sizeof(LevelFileHeader) + levelFileEarthWords(h) * sizeof(uint64_t) + static_cast<size_t>(h.numPlacements) * sizeof(LevelPlacement))
+        return false;
+    
+    //Every placement must be a known kind of object lying entirely inside the field, and there has to be oil to find
+    const int objectSize = 4;
+    int numBarrels = 0;
+    const LevelPlacement* p = placements();
+    for(uint32_t i = 0; i < h.numPlacements; i++){
+        if(p[i].gameID != 'B' && p[i].gameID != 'O' && p[i].gameID != 'G')
+            return false;
+        if(p[i].x < 0 || p[i].x + objectSize > static_cast<int>(h.fieldWidth) || p[i].y < 0 || p[i].y + objectSize > static_cast<int>(h.fieldHeight))
+            return false;
+        if(p[i].gameID == 'O')
+            numBarrels++;
+    }
+    return numBarrels > 0;
+}
+
+bool writeLevelFile(const string& path, const LevelLayout& layout){
+    LevelFileHeader header = LevelFileHeader();
+    copy(levelFileMagic, levelFileMagic + sizeof(levelFileMagic), header.magic);
+    header.version = levelFileVersion;
+    header.fieldWidth = layout.earth.width();
+    header.fieldHeight = layout.earth.height();
+    header.numPlacements = static_cast<uint32_t>(layout.boulders.size() + layout.barrels.size() + layout.nuggets.size());
+    
+    vector<LevelPlacement> placements;
+    const pair<char, const vector<FieldPosition>*> kinds[] = {{'B', &layout.boulders}, {'O', &layout.barrels}, {'G', &layout.nuggets}};
+    for(const auto& kind : kinds){
+        for(const FieldPosition& position : *kind.second){
+            LevelPlacement p = LevelPlacement();
+            p.gameID = kind.first;
+            p.x = static_cast<int16_t>(position.x);
+            p.y = static_cast<int16_t>(position.y);
+            placements.push_back(p);
+        }
+    }
+    
+    ofstream file(path, ios::out | ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    vector<uint64_t> earthRows(layout.earth.numWords());
+    layout.earth.copyWords(earthRows.data());
+    file.write(reinterpret_cast<const char*>(earthRows.data()), earthRows.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(placements.data()), placements.size() * sizeof(LevelPlacement));
+    return file.good();
+}
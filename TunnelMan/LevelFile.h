@@ -0,0 +1,77 @@
+#ifndef LEVELFILE_H_
+#define LEVELFILE_H_
+
+#include "LevelGenerator.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//A level file is a hand-built (or exported) level in a flat, fixed layout that is mapped into memory and used in place:
+//
+//  LevelFileHeader
+//  uint64_t earthRows[fieldHeight * ((fieldWidth+63)/64)]   bit x of row y is set when there is earth at (x, y)
+//  LevelPlacement placements[numPlacements]                   where each boulder, barrel and gold nugget starts
+
+const char levelFileMagic[4] = {'T', 'M', 'L', 'V'};
+const uint32_t levelFileVersion = 1;
+
+struct LevelFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint32_t fieldWidth;
+    uint32_t fieldHeight;
+    uint32_t numPlacements;
+    uint32_t reserved;
+};
+
+//gameID is 'B' for a boulder, 'O' for a barrel or 'G' for a gold nugget
+struct LevelPlacement{
+    char gameID;
+    uint8_t reserved;
+    int16_t x;
+    int16_t y;
+    int16_t reserved2;
+};
+
+static_assert(sizeof(LevelFileHeader) % 8 == 0, "earth rows after the header must stay 8-byte aligned");
+static_assert(sizeof(LevelPlacement) == 8, "placements must keep a fixed on-disk size");
+
+//A read-only view of a level file. On POSIX systems the file is memory-mapped; elsewhere it is read into a buffer
+class LevelFile{
+public:
+    LevelFile();
+    ~LevelFile();
+    
+    //Maps the file in and checks it thoroughly. Returns false (leaving nothing open) if it can't be read or is malformed
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    
+    //returns the whole file's bytes
+    const char* data() const;
+    size_t size() const;
+    
+    const LevelFileHeader& header() const;
+    const uint64_t* earthRows() const;
+    const LevelPlacement* placements() const;
+    
+    //Copies the level into a layout the world can install
+    void getLayout(int level, LevelLayout& layout) const;
+    
+private:
+    const char* m_data;
+    size_t m_size;
+    std::vector<char> m_buffer;     //holds the file when it can't be mapped
+    
+    bool isValid() const;
+    
+    //Prevent copying or assigning LevelFiles
+    LevelFile(const LevelFile&);
+    LevelFile& operator=(const LevelFile&);
+};
+
+//Writes a layout out as a level file. Returns false if the file can't be written
+bool writeLevelFile(const std::string& path, const LevelLayout& layout);
+
+#endif // LEVELFILE_H_
@@ -0,0 +1,128 @@
+#include "LevelGenerator.h"
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+//How many random candidates each placement tries before falling back to a scan of its whole range
+const int placementDartTries = 30;
+
+//Objects that start out in the field must be more than this far apart
+const int placementMinDistance = 6;
+
+//Returns a number in [lo, hi] drawn from rng. How std::uniform_int_distribution turns the engine's numbers into a range
+//is up to the standard library, which would make the same seed lay levels out differently on different compilers
+static int randomInRange(mt19937& rng, int lo, int hi){
+    uint64_t range = static_cast<uint64_t>(hi - lo) + 1;
+    //Reject the engine's top few values, which would otherwise make the low end of the range come up more often
+    uint64_t limit = (uint64_t(1) << 32) / range * range;
+    uint64_t value;
+    do{
+        value = rng();
+    }while(value >= limit);
+    return lo + static_cast<int>(value % range);
+}
+
+
+
+/*                          PoissonDiskPlacer implementation                   */
+
+PoissonDiskPlacer::PoissonDiskPlacer(int fieldWidth, int fieldHeight, int minDistance){
+    m_minDistance = minDistance;
+    //Two points in the same cell are at most cellSize*sqrt(2) apart, which must not exceed minDistance
+    m_cellSize = max(1, static_cast<int>(minDistance / 1.5));
+    m_gridWidth = (fieldWidth + m_cellSize - 1) / m_cellSize;
+    m_gridHeight = (fieldHeight + m_cellSize - 1) / m_cellSize;
+    m_reach = (minDistance + m_cellSize - 1) / m_cellSize;
+    m_grid.assign(m_gridWidth * m_gridHeight, -1);
+}
+
+bool PoissonDiskPlacer::place(int minX, int maxX, int minY, int maxY, const function<bool(int x, int y)>& excluded, mt19937& rng, FieldPosition& out){
+    if(minX > maxX || minY > maxY)
+        return false;
+
+    for(int i = 0; i < placementDartTries; i++){
+        int x = randomInRange(rng, minX, maxX);
+        int y = randomInRange(rng, minY, maxY);
+        if((!excluded || !excluded(x, y)) && fits(x, y)){
+            accept(x, y);
+            out = {x, y};
+            return true;
+        }
+    }
+
+    //The field is crowded enough that darts keep missing: walk every position in the range once, starting somewhere random
+    int width = maxX - minX + 1;
+    int area = width * (maxY - minY + 1);
+    int start = randomInRange(rng, 0, area - 1);
+    for(int i = 0; i < area; i++){
+        int index = (start + i) % area;
+        int x = minX + index % width;
+        int y = minY + index / width;
+        if((!excluded || !excluded(x, y)) && fits(x, y)){
+            accept(x, y);
+            out = {x, y};
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PoissonDiskPlacer::fits(int x, int y) const{
+    int cellX = x / m_cellSize;
+    int cellY = y / m_cellSize;
+    for(int gy = max(0, cellY - m_reach); gy <= min(m_gridHeight - 1, cellY + m_reach); gy++){
+        for(int gx = max(0, cellX - m_reach); gx <= min(m_gridWidth - 1, cellX + m_reach); gx++){
+            int index = m_grid[gy * m_gridWidth + gx];
+            if(index < 0)
+                continue;
+            int dx = m_points[index].x - x;
+            int dy = m_points[index].y - y;
+            if(dx*dx + dy*dy <= m_minDistance * m_minDistance)
+                return false;
+        }
+    }
+    return true;
+}
+
+void PoissonDiskPlacer::accept(int x, int y){
+    m_grid[(y / m_cellSize) * m_gridWidth + x / m_cellSize] = static_cast<int>(m_points.size());
+    m_points.push_back({x, y});
+}
+
+
+
+/*                          Level layout                   */
+
+static void placeObjects(PoissonDiskPlacer& placer, int count, int minX, int maxX, int minY, int maxY,
+                         const function<bool(int x, int y)>& excluded, mt19937& rng, vector<FieldPosition>& positions){
+    positions.clear();
+    for(int i = 0; i < count; i++){
+        FieldPosition p;
+        if(!placer.place(minX, maxX, minY, maxY, excluded, rng, p))
+            break; //No room left for any more of these
+        positions.push_back(p);
+    }
+}
+
+void generateLevelLayout(int level, const LevelParams& params, int fieldWidth, int fieldHeight, unsigned int seed, LevelLayout& layout){
+    mt19937 rng(seed);
+    PoissonDiskPlacer placer(fieldWidth, fieldHeight, placementMinDistance);
+    layout.level = level;
+
+    //Boulders may not start in or right next to the central shaft
+    int shaftLeft = fieldWidth / 2 - 2;
+    auto nearTunnel = [shaftLeft](int x, int y){
+        return (x >= shaftLeft - 4 && x <= shaftLeft + 4) && (y >= 4);
+    };
+
+    //On the standard 64x64 field these are the ranges the objects have always started in
+    placeObjects(placer, params.numBoulders, 1, fieldWidth - 10, 20, fieldHeight - 10, nearTunnel, rng, layout.boulders);
+    placeObjects(placer, params.numBarrels, 0, fieldWidth - 4, 0, fieldHeight - 9, nullptr, rng, layout.barrels);
+    placeObjects(placer, params.numNuggets, 0, fieldWidth - 5, 0, fieldHeight - 9, nullptr, rng, layout.nuggets);
+
+    layout.earth.resize(fieldWidth, fieldHeight);
+    layout.earth.reset();
+    for(const FieldPosition& p : layout.boulders)
+        layout.earth.clearSquare(p.x, p.y);
+}
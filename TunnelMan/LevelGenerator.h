@@ -0,0 +1,53 @@
+#ifndef LEVELGENERATOR_H_
+#define LEVELGENERATOR_H_
+
+#include "EarthField.h"
+#include "LevelParams.h"
+#include <functional>
+#include <random>
+#include <vector>
+
+struct FieldPosition{
+    int x;
+    int y;
+};
+
+//How a level starts out: its earth (with the boulders' squares already dug out) and where its boulders, barrels and gold nuggets are
+struct LevelLayout{
+    int level;
+    EarthField earth;
+    std::vector<FieldPosition> boulders;
+    std::vector<FieldPosition> barrels;
+    std::vector<FieldPosition> nuggets;
+};
+
+//Scatters points so that no two are within a minimum distance of each other. Accepted points are kept in a background
+//grid whose cells are small enough to hold at most one point, so checking a candidate only looks at the few cells
+//around it instead of at every point placed so far
+class PoissonDiskPlacer{
+public:
+    PoissonDiskPlacer(int fieldWidth, int fieldHeight, int minDistance);
+
+    //Places a point uniformly at random in [minX, maxX] x [minY, maxY] that is more than minDistance from every point
+    //placed so far and not excluded. Tries a bounded number of random candidates, then scans the whole range from a
+    //random starting point, so it always terminates. Returns false if no position in the range fits
+    bool place(int minX, int maxX, int minY, int maxY, const std::function<bool(int x, int y)>& excluded, std::mt19937& rng, FieldPosition& out);
+
+private:
+    int m_minDistance;
+    int m_cellSize;
+    int m_gridWidth;
+    int m_gridHeight;
+    int m_reach;                        //how many cells around a candidate's cell could hold a point that's too close
+    std::vector<FieldPosition> m_points;
+    std::vector<int> m_grid;            //index into m_points of the point in each cell, or -1
+
+    bool fits(int x, int y) const;
+    void accept(int x, int y);
+};
+
+//Lays out the given level on a field of the given size using its own random number generator, so it can run anywhere
+//(including off the main thread) and is reproducible from the seed
+void generateLevelLayout(int level, const LevelParams& params, int fieldWidth, int fieldHeight, unsigned int seed, LevelLayout& layout);
+
+#endif // LEVELGENERATOR_H_
@@ -0,0 +1,106 @@
+#include "LevelParams.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+static constexpr array<LevelParams, numTabulatedLevels> levelParamsTable = makeLevelParamsTable();
+
+static_assert(levelParamsTable[0].numBarrels == 2 && levelParamsTable[0].targetNumProtestors == 2, "level 0 settings");
+static_assert(levelParamsTable[11].protestorStunTicks == 50 && levelParamsTable[16].protestorRestTicks == 0, "settings must not wrap around");
+
+LevelParams standardLevelParams(int level){
+    if(level >= 0 && level < numTabulatedLevels)
+        return levelParamsTable[level];
+    return computeLevelParams(level);
+}
+
+//The settings a config file may name, and the smallest value each may take
+struct LevelParamField{
+    const char* name;
+    int LevelParams::*field;
+    int minValue;
+};
+
+static const LevelParamField levelParamFields[] = {
+    {"numBoulders", &LevelParams::numBoulders, 0},
+    {"numBarrels", &LevelParams::numBarrels, 1},
+    {"numNuggets", &LevelParams::numNuggets, 0},
+    {"minTicksBetweenProtestors", &LevelParams::minTicksBetweenProtestors, 0},
+    {"targetNumProtestors", &LevelParams::targetNumProtestors, 0},
+    {"hardcoreProbability", &LevelParams::hardcoreProbability, 0},
+    {"goodieChance", &LevelParams::goodieChance, 1},
+    {"goodieLifetime", &LevelParams::goodieLifetime, 1},
+    {"protestorRestTicks", &LevelParams::protestorRestTicks, 0},
+    {"protestorStunTicks", &LevelParams::protestorStunTicks, 0},
+    {"hardcoreTrackingMoves", &LevelParams::hardcoreTrackingMoves, 0},
+    {"aiLodNearDistance", &LevelParams::aiLodNearDistance, 0},
+    {"aiLodFarDistance", &LevelParams::aiLodFarDistance, 0},
+    {"aiLodMidStride", &LevelParams::aiLodMidStride, 1},
+    {"aiLodFarStride", &LevelParams::aiLodFarStride, 1},
+};
+
+bool LevelParamsOverrides::load(const string& path){
+    m_overrides.clear();
+    m_source.clear();
+    ifstream file(path);
+    if(!file)
+        return false;
+    
+    vector<Override> overrides;
+    string source;
+    string line;
+    while(getline(file, line)){
+        line.erase(remove_if(line.begin(), line.end(), [](char c){ return c == ' ' || c == '\t' || c == '\r'; }), line.end());
+        if(line.empty() || line[0] == '#')
+            continue;
+        
+        size_t equals = line.find('=');
+        if(equals == string::npos)
+            return false;
+        string name = line.substr(0, equals);
+        Override o;
+        o.level = -1;
+        
+        size_t bracket = name.find('[');
+        if(bracket != string::npos){
+            if(name.back() != ']')
+                return false;
+            istringstream levelText(name.substr(bracket + 1, name.size() - bracket - 2));
+            if(!(levelText >> o.level) || !levelText.eof() || o.level < 0)
+                return false;
+            name.erase(bracket);
+        }
+        
+        const LevelParamField* field = find_if(begin(levelParamFields), end(levelParamFields),
+                                               [&name](const LevelParamField& f){ return name == f.name; });
+        if(field == end(levelParamFields))
+            return false;
+        o.field = field->field;
+        
+        istringstream valueText(line.substr(equals + 1));
+        if(!(valueText >> o.value) || !valueText.eof() || o.value < field->minValue)
+            return false;
+        overrides.push_back(o);
+        source += line;
+        source += '\n';
+    }
+    
+    //Settings for every level go first so the ones for a particular level win
+    stable_partition(overrides.begin(), overrides.end(), [](const Override& o){ return o.level < 0; });
+    m_overrides.swap(overrides);
+    m_source.swap(source);
+    return true;
+}
+
+void LevelParamsOverrides::apply(int level, LevelParams& params) const{
+    for(size_t i = 0; i < m_overrides.size(); i++){
+        if(m_overrides[i].level < 0 || m_overrides[i].level == level)
+            params.*m_overrides[i].field = m_overrides[i].value;
+    }
+}
+
+const string& LevelParamsOverrides::getSource() const{
+    return m_source;
+}
@@ -0,0 +1,98 @@
+#ifndef LEVELPARAMS_H_
+#define LEVELPARAMS_H_
+
+#include <array>
+#include <string>
+#include <vector>
+
+//Every difficulty setting that depends on the level, worked out once when the level starts so the game never has to
+//recompute them while it runs
+struct LevelParams{
+    int numBoulders;
+    int numBarrels;
+    int numNuggets;
+    int minTicksBetweenProtestors;
+    int targetNumProtestors;
+    int hardcoreProbability;        //percent chance that a new protestor is a hardcore one
+    int goodieChance;               //each tick, a sonar kit or water pool shows up with a 1 in goodieChance chance
+    int goodieLifetime;             //ticks a sonar kit or water pool stays in the field
+    int protestorRestTicks;         //ticks a protestor waits between moves
+    int protestorStunTicks;         //ticks an annoyed protestor stays put (and a bribed hardcore protestor's rest count)
+    int hardcoreTrackingMoves;      //how many moves away a hardcore protestor can sense the TunnelMan from
+    //Distance bands for AI level of detail (StudentWorld::setAiLod): a wandering protestor at least aiLodNearDistance
+    //from the TunnelMan acts only every aiLodMidStride-th turn, or every aiLodFarStride-th from aiLodFarDistance on,
+    //making that many moves each time
+    int aiLodNearDistance;
+    int aiLodFarDistance;
+    int aiLodMidStride;
+    int aiLodFarStride;
+};
+
+constexpr int minOf(int a, int b){
+    return a < b ? a : b;
+}
+
+constexpr int maxOf(int a, int b){
+    return a > b ? a : b;
+}
+
+//The standard settings for a level. Everything is signed, so none of them wrap around at high levels
+constexpr LevelParams computeLevelParams(int level){
+    LevelParams p{};
+    p.numBoulders = minOf(level / 2 + 2, 9);
+    p.numBarrels = minOf(21, 2 + level);
+    p.numNuggets = maxOf(2, 5 - level / 2);
+    p.minTicksBetweenProtestors = maxOf(25, 200 - level);
+    p.targetNumProtestors = minOf(15, 2 + level * 3 / 2);
+    p.hardcoreProbability = minOf(90, level * 10 + 30);
+    p.goodieChance = level * 25 + 300;
+    p.goodieLifetime = maxOf(100, 300 - 10 * level);
+    p.protestorRestTicks = maxOf(0, 3 - level / 4);
+    p.protestorStunTicks = maxOf(50, 100 - level * 10);
+    p.hardcoreTrackingMoves = 16 + level * 2;
+    p.aiLodNearDistance = 16;
+    p.aiLodFarDistance = 32;
+    p.aiLodMidStride = 2;
+    p.aiLodFarStride = 4;
+    return p;
+}
+
+//Levels whose standard settings are built into a table at compile time
+const int numTabulatedLevels = 64;
+
+constexpr std::array<LevelParams, numTabulatedLevels> makeLevelParamsTable(){
+    std::array<LevelParams, numTabulatedLevels> table{};
+    for(int level = 0; level < numTabulatedLevels; level++)
+        table[level] = computeLevelParams(level);
+    return table;
+}
+
+//returns the standard settings for a level
+LevelParams standardLevelParams(int level);
+
+//Settings read from a config file that replace the standard ones. Each line is "name = value", which applies to every
+//level, or "name[level] = value", which applies to just that level and wins over the former. Blank lines and lines
+//starting with # are ignored; the names are the LevelParams field names
+class LevelParamsOverrides{
+public:
+    //Reads a config file. Returns false, keeping no overrides, if it can't be read or has a line it doesn't understand
+    bool load(const std::string& path);
+    
+    //Replaces the settings in params that the config file sets for the given level
+    void apply(int level, LevelParams& params) const;
+    
+    //returns the lines the overrides were read from, stripped of whitespace and comments (empty if there are none), to
+    //tell one set of overrides from another
+    const std::string& getSource() const;
+    
+private:
+    struct Override{
+        int level;                  //-1 for every level
+        int LevelParams::*field;
+        int value;
+    };
+    std::vector<Override> m_overrides;
+    std::string m_source;
+};
+
+#endif // LEVELPARAMS_H_
@@ -0,0 +1,65 @@
+#include "PackedPositions.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PACKED_POSITIONS_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+void PackedPositions::add(int x, int y){
+    m_xy.push_back(static_cast<int16_t>(x));
+    m_xy.push_back(static_cast<int16_t>(y));
+}
+
+void PackedPositions::set(size_t i, int x, int y){
+    m_xy[2*i] = static_cast<int16_t>(x);
+    m_xy[2*i + 1] = static_cast<int16_t>(y);
+}
+
+void PackedPositions::resize(size_t n){
+    m_xy.resize(2*n);
+}
+
+void PackedPositions::erase(size_t i){
+    m_xy.erase(m_xy.begin() + 2*i, m_xy.begin() + 2*i + 2);
+}
+
+void PackedPositions::clear(){
+    m_xy.clear();
+}
+
+uint64_t PackedPositions::withinRadius(size_t first, int x, int y, int radius, bool inclusive) const{
+    if(first >= size())
+        return 0;
+    size_t count = size() - first;
+    if(count > blockSize)
+        count = blockSize;
+
+    //Entries within the radius have a squared distance of at most limit
+    int32_t limit = radius * radius - (inclusive ? 0 : 1);
+    const int16_t* xy = m_xy.data() + 2*first;
+    uint64_t hits = 0;
+    size_t i = 0;
+
+#if defined(PACKED_POSITIONS_SSE2)
+    //Four (x, y) pairs per register: subtract the query point from each, then madd squares and sums each pair into dx*dx + dy*dy
+    uint32_t packedOrigin = (static_cast<uint32_t>(static_cast<uint16_t>(y)) << 16) | static_cast<uint16_t>(x);
+    __m128i origin = _mm_set1_epi32(static_cast<int32_t>(packedOrigin));
+    __m128i limits = _mm_set1_epi32(limit);
+    for(; i + 4 <= count; i += 4){
+        __m128i d = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xy + 2*i)), origin);
+        __m128i squared = _mm_madd_epi16(d, d);
+        int tooFar = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(squared, limits)));
+        hits |= static_cast<uint64_t>(~tooFar & 0xF) << i;
+    }
+#endif
+
+    for(; i < count; i++){
+        int dx = xy[2*i] - x;
+        int dy = xy[2*i + 1] - y;
+        if(dx * dx + dy * dy <= limit)
+            hits |= uint64_t(1) << i;
+    }
+    return hits;
+}
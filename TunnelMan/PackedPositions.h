@@ -0,0 +1,58 @@
+#ifndef PACKEDPOSITIONS_H_
+#define PACKEDPOSITIONS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//The positions of a list of actors, kept as packed 16-bit (x, y) pairs in the same order as the list so radius searches
+//can test several actors at once (four per SSE2 instruction) without touching the actors themselves
+class PackedPositions{
+public:
+    //How many entries one call to withinRadius looks at
+    static constexpr size_t blockSize = 64;
+
+    size_t size() const{
+        return m_xy.size() / 2;
+    }
+
+    int x(size_t i) const{
+        return m_xy[2*i];
+    }
+
+    int y(size_t i) const{
+        return m_xy[2*i + 1];
+    }
+
+    void add(int x, int y);
+    void set(size_t i, int x, int y);
+    //Keeps the first n entries
+    void resize(size_t n);
+    void erase(size_t i);
+    void clear();
+
+    //Bit i of the result is set when entry first+i (one of the blockSize entries from first on) is at most radius away from
+    //(x, y), or less than radius away when inclusive is false. Exact: it compares squared distances. (x, y) has to be a
+    //field position (or just off the field)
+    uint64_t withinRadius(size_t first, int x, int y, int radius, bool inclusive) const;
+
+private:
+    std::vector<int16_t> m_xy; //x0, y0, x1, y1, ...
+};
+
+//returns the index of the lowest set bit of a non-zero mask
+inline int lowestBit(uint64_t mask){
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+#endif // PACKEDPOSITIONS_H_
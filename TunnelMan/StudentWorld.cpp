@@ -1,49 +1,145 @@
 #include "StudentWorld.h"
 #include "Actor.h"
+#include "WorldOptions.h"
 #include <cmath>
+#include <cstdio>
+#include <cstdint>
 #include <queue>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <fstream>
 
 using namespace std;
 
+namespace{
+    //Takes the actor at index i out of a category list and its positions, renumbering the ones after it
+    template<typename T>
+    void eraseFromList(vector<T*>& actors, PackedPositions& positions, int i){
+        actors.erase(actors.begin() + i);
+        positions.erase(i);
+        for(size_t j = i; j < actors.size(); j++)
+            actors[j]->setListIndex(static_cast<int>(j));
+    }
+    
+    //Takes every dead actor out of a category list and its positions, keeping the rest in order
+    template<typename T>
+    void removeDeadFromList(vector<T*>& actors, PackedPositions& positions){
+        size_t kept = 0;
+        for(size_t i = 0; i < actors.size(); i++){
+            if(!actors[i]->getLiveStatus())
+                continue;
+            actors[kept] = actors[i];
+            actors[kept]->setListIndex(static_cast<int>(kept));
+            positions.set(kept, positions.x(i), positions.y(i));
+            kept++;
+        }
+        actors.resize(kept);
+        positions.resize(kept);
+    }
+}
+
 //PUBLIC STUDENTWORLD INTERFACE
 
-StudentWorld::StudentWorld(std::string assetDir) : GameWorld(assetDir){}
+StudentWorld::StudentWorld(std::string assetDir) : GameWorld(assetDir){
+    m_displayedStatsValid = false;
+    m_statText[0] = '\0';
+    m_tickNumber = 0;
+    m_replaying = false;
+    m_fastRestart = false;
+    m_aiLod = false;
+    m_viewX = 0;
+    m_viewY = 0;
+    m_mazeVersion = 0;
+    m_turnsTaken = SIZE_MAX;
+    m_recentMazeField = 0;
+    m_mazeFields[0].valid = false;
+    m_mazeFields[1].valid = false;
+    setFieldSize(VIEW_WIDTH, VIEW_HEIGHT);
+}
+
+StudentWorld::~StudentWorld(){
+    if(m_recorder.isOpen()){
+        InputLogResults results;
+        results.finalTick = m_tickNumber;
+        results.level = getLevel();
+        results.lives = getLives();
+        results.score = getScore();
+        m_recorder.finish(results);
+    }
+}
 
 int StudentWorld::init()
 {
+    m_displayedStatsValid = false;
+    m_params = paramsForLevel(getLevel());
+    m_wheel.reset(m_tickNumber);
+    
+    //Restore a loaded snapshot, or the current level as first laid out when fast restarts are on
+    if(!m_pendingSnapshot.empty()){
+        restoreSnapshot(m_pendingSnapshot, true);
+        m_pendingSnapshot.clear();
+        return GWSTATUS_CONTINUE_GAME;
+    }
+    if(m_fastRestart && !m_levelStartSnapshot.empty() &&
+       reinterpret_cast<const SnapshotHeader*>(m_levelStartSnapshot.data())->level == getLevel()){
+        restoreSnapshot(m_levelStartSnapshot, false);
+        return GWSTATUS_CONTINUE_GAME;
+    }
+    
     //Populate field with objects that start out:
-    populateFieldWithEarth();
-    populateFieldWithBoulders();
-    populateFieldWithBarrels();
-    populateFieldWithNuggets();
+    LevelLayout layout;
+    if(!takeLevelLayout(layout))
+        return GWSTATUS_LEVEL_ERROR;
+    populateFieldWithEarth(layout.earth);
+    populateFieldWithBoulders(layout.boulders);
+    populateFieldWithBarrels(layout.barrels);
+    populateFieldWithNuggets(layout.nuggets);
     
     
     //Set appropriate tick counts
     m_numProtestors = 0;
     m_ticksSinceLastProtestorAdded = 1000; //So that a protestor will be added on the very first tick
-    m_minTicksBetweenProtestors = fmax(25, 200 - getLevel());
+    m_minTicksBetweenProtestors = m_params.minTicksBetweenProtestors;
     
 
     //Create the tunnelman
     m_player = new TunnelMan(this); //Create a new TunnelMan
+    updateCamera();
+    
+    if(m_fastRestart)
+        saveSnapshot(m_levelStartSnapshot);
+    if(!m_levelStartSnapshotFile.empty() && !saveSnapshotToFile(m_levelStartSnapshotFile))
+        cout << "Cannot write snapshot " << m_levelStartSnapshotFile << endl;
     
     return GWSTATUS_CONTINUE_GAME; //must return this to continue the game
 }
 
 int StudentWorld::move(){
     
+    m_tickNumber++;
+    m_turnsTaken = 0;
+    m_wheel.advance(m_tickNumber, m_firedTimers);
+    for(TimerNode* t : m_firedTimers){
+        Actor* a = static_cast<Actor*>(t->owner);
+        a->wakeUp();
+        actorTurnStateChanged(a);
+    }
+    m_firedTimers.clear();
+    if(m_timeline.isEnabled()){
+        saveSnapshot(m_timelineImage);
+        m_timeline.record(m_tickNumber, m_timelineImage);
+    }
     updateDisplayText();
     
     //ADD ACTORS IF NEEDED
     
     //Add protestors if needed
-    int targetNumOfProtestors = fmin(15, 2 + getLevel() * 1.5);
-    if(m_ticksSinceLastProtestorAdded >= m_minTicksBetweenProtestors && m_numProtestors < targetNumOfProtestors){
+    if(m_ticksSinceLastProtestorAdded >= m_minTicksBetweenProtestors && m_numProtestors < m_params.targetNumProtestors){
         
         int i = rand() % 100 + 1;
-        int p = fmin(90, getLevel()*10 + 30);
         
-        if(i <= p){
+        if(i <= m_params.hardcoreProbability){
             addActor(new HardcoreProtestor(this));
         }
         else{
@@ -55,56 +151,56 @@ int StudentWorld::move(){
     m_ticksSinceLastProtestorAdded++;
     
     //Add sonar/water if needed
-    int g = getLevel() * 25 + 300;
-    int i = rand() % g;
+    int i = rand() % m_params.goodieChance;
     if(i == 0){
         int j = rand() % 5;
         if(j == 0){//Add a Sonarkit
             Actor* a = new SonarKit(this);
             addActor(a);
         }
-        else{//Add a waterpool
+        else if(m_freeCells.size() > 0){//Add a waterpool on a random spot with no earth
             
             int x;
             int y;
-            do{
-                x = rand() % 61;
-                y = rand() % 61;
-            }while(earthAt(x, y));
+            m_freeCells.nth(rand() % m_freeCells.size(), x, y);
             
             Actor* a = new WaterPool(this, x, y);
             addActor(a);
         }
     }
     
-    if(m_player->getLiveStatus())
+    if(m_player->getLiveStatus()){
         m_player->doSomething();
+        updateCamera();
+        triggerGoodiesNear(m_player->getX(), m_player->getY());
+    }
     else{
         decLives();
         return GWSTATUS_PLAYER_DIED;
     }
     
-    for(int i = 0; i != m_gameObjects.size(); i++){
+    prepareMazeFields();
+    decideProtestorIntents();
     
-        if(m_gameObjects[i]->getLiveStatus()){
-            m_gameObjects[i]->doSomething();
+    for(size_t i = 0; i != m_gameObjects.size(); i++){
+    
+        if(wantsTurn(i)){
+            m_turnsTaken = i;
+            updateActor(m_gameObjects[i]);
             if(!m_player->getLiveStatus()){
                 decLives();
                 return GWSTATUS_PLAYER_DIED;
             }
             if(playerCompletedLevel()){
+                prepareNextLevel();
                 playSound(SOUND_FINISHED_LEVEL);
                 return GWSTATUS_FINISHED_LEVEL;
             }
         }
     }
+    m_turnsTaken = SIZE_MAX;
 
-    for(int i = 0; i != m_gameObjects.size(); i++){
-        if(!m_gameObjects[i]->getLiveStatus()){
-            removeActor(m_gameObjects[i]);
-            i--;
-        }
-    }
+    removeDeadActors();
     
     
     if(m_player->getLiveStatus())
@@ -116,74 +212,72 @@ int StudentWorld::move(){
 }
 
 void StudentWorld::cleanUp(){
-    vector<Actor*>::iterator it;
-    
-    it = m_gameObjects.begin();
-    while(it != m_gameObjects.end()){
-        delete *it;
-        it = m_gameObjects.erase(it);
+    //Hide the old actors and hand them all to the reclaimer thread to delete, so the next init() can start right away
+    size_t numActors = m_gameObjects.size();
+    for(size_t i = 0; i < numActors; i++){
+        m_gameObjects[i]->setVisible(false);
+        m_gameObjects[i]->setUpdateIndex(-1);
     }
+    m_player->setVisible(false);
+    m_gameObjects.push_back(m_player);
+    m_player = nullptr;
+    m_reclaimer.retire(m_gameObjects);
+    m_gameObjects.clear();
+    m_turnKinds.clear();
+    m_turnFlags.clear();
+    m_boulders.clear();
+    m_protestors.clear();
+    m_boulderPositions.clear();
+    m_protestorPositions.clear();
+    for(vector<Goodie*>& bucket : m_goodieBuckets)
+        bucket.clear();
+    m_wheel.reset(m_tickNumber); //the retired actors' timers go with them
+    m_turnsTaken = SIZE_MAX;
+    m_mazeVersion++;
     
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            delete m_earthTracker[i][j];
-        }
-    }
-    delete m_player;
+    //The earth needs no teardown; init() refills it in place
 }
 
 
 void StudentWorld::removeEarth(int x, int y){
-    for(int i = 0; i < actorSize; i++){
-        for(int j = 0; j < actorSize; j++){
-            if(inField(x+j, y+i) && m_earthTracker[y+i][x+j] != nullptr){
-                delete m_earthTracker[y+i][x+j];
-                m_earthTracker[y+i][x+j] = nullptr;
-            }
+    m_earth.clearSquare(x, y);
+    m_mazeVersion++;
+    wakeBouldersAbove(x, y, x + actorSize, y + actorSize);
+    
+    //Any spot overlapping the dug square may have just been cleared of its last earth
+    for(int spotY = max(y - actorSize + 1, 0); spotY <= min(y + actorSize - 1, m_fieldHeight - actorSize); spotY++){
+        for(int spotX = max(x - actorSize + 1, 0); spotX <= min(x + actorSize - 1, m_fieldWidth - actorSize); spotX++){
+            if(!m_freeCells.contains(spotX, spotY) && !m_earth.anyInSquare(spotX, spotY))
+                m_freeCells.add(spotX, spotY);
         }
     }
 }
 
 bool StudentWorld::earthAt(int x, int y) const{
-    for(int i = 0; i < actorSize; i++){
-        for(int j = 0; j < actorSize; j++){
-            if(inField(x+j, y+i) && m_earthTracker[y+i][x+j] != nullptr){
-                return true;
-            }
-        }
-    }
-    return false;
+    return m_earth.anyInSquare(x, y);
+}
+
+bool StudentWorld::hasEarthCell(int x, int y) const{
+    return m_earth.cellAt(x, y);
 }
 
 
 
 bool StudentWorld::boulderWithinRadius3(int x, int y) const {
-    for(int k = 0; k < m_gameObjects.size(); k++){
-        if(m_gameObjects[k]->getGameID() == 'B'){
-            int bX = m_gameObjects[k]->getX();
-            int bY = m_gameObjects[k]->getY();
-            
-            if(distanceApart(x, y, bX, bY) <= 3)
-                return true;
-        }
+    for(size_t first = 0; first < m_boulders.size(); first += PackedPositions::blockSize){
+        if(m_boulderPositions.withinRadius(first, x, y, 3, true) != 0)
+            return true;
     }
     return false;
 }
 
 bool StudentWorld::boulderAt(int x, int y) const{
-    
-    for(int k = 0; k < m_gameObjects.size(); k++){
-        if(m_gameObjects[k]->getGameID() == 'B'){
-            for(int i = 0; i < actorSize; i++){
-                for(int j = 0; j < actorSize; j++){
-                    if(inField(x-j, y-i)){
-                        if(m_gameObjects[k]->getX() == x-j && m_gameObjects[k]->getY() == y-i){
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
+    //A boulder covers the 4x4 square with its bottom left corner at its position
+    for(size_t i = 0; i < m_boulderPositions.size(); i++){
+        int bX = m_boulderPositions.x(i);
+        int bY = m_boulderPositions.y(i);
+        if(bX <= x && x < bX + actorSize && bY <= y && y < bY + actorSize)
+            return true;
     }
     return false;
 
@@ -202,53 +296,82 @@ bool StudentWorld::actorWillOverlapBoulder(int x, int y) const{
 void StudentWorld::illuminateOilField(int x, int y, int radius) {
     vector<Actor*>::iterator it;
     for(it = m_gameObjects.begin(); it != m_gameObjects.end(); it++){
-        if(distanceApart(x, y, (*it)->getX(), (*it)->getY()) < radius)
+        if(squaredDistance(x, y, (*it)->getX(), (*it)->getY()) < radius * radius)
             (*it)->setVisible(true);
     }
 }
 
-vector<Actor*> StudentWorld::findProtestorsWithinRadius(int x, int y, int radius){
-    vector<Actor*> output;
-    for(int i = 0; i != m_gameObjects.size(); i++){
-        Actor* a = m_gameObjects[i];
-        if((a->getGameID() == 'p' || a->getGameID() == 'P') && a->getLiveStatus()){
-            if(distanceApart(x, y, a->getX(), a->getY()) <= radius)
-                output.push_back(a);
+Protestor* StudentWorld::findProtestorWithinRadius(int x, int y, int radius) const{
+    Protestor* found = nullptr;
+    forEachProtestorWithinRadius(x, y, radius, [&found](Protestor* p){
+        found = p;
+        return false;
+    });
+    return found;
+}
+
+int StudentWorld::findProtestorsWithinRadius(int x, int y, int radius, ProtestorMatches& matches) const{
+    matches.count = 0;
+    matches.truncated = false;
+    forEachProtestorWithinRadius(x, y, radius, [&matches](Protestor* p){
+        if(matches.count == ProtestorMatches::capacity){
+            matches.truncated = true;
+            return false;
         }
-    }
-    return output;
+        matches.protestors[matches.count++] = p;
+        return true;
+    });
+    return matches.count;
 }
 
 bool StudentWorld::tunnelManWithinRadius(int x, int y, int radius  ){
-    if(distanceApart(x, y, m_player->getX(), m_player->getY()) <= radius)
+    if(squaredDistance(x, y, m_player->getX(), m_player->getY()) <= radius * radius)
         return true;
     else
         return false;
 }
 
-bool StudentWorld::killProtestorsWithinRadius(int x, int y, int radius){
-    bool output = false;
-    vector<Actor*> doomed = findProtestorsWithinRadius(x, y, radius);
-    if(doomed.size() != 0){
-        output = true;
-        for(int i = 0; i < doomed.size(); i++){
-            doomed[i]->annoy(100); //AllocatePoints in the protestor::annoy function
-        }
-    }
-    return output;
+int StudentWorld::protestorUpdateStride(const Protestor* p) const{
+    if(!m_aiLod)
+        return 1;
+    int distanceSquared = squaredDistance(p->getX(), p->getY(), m_player->getX(), m_player->getY());
+    if(distanceSquared < m_params.aiLodNearDistance * m_params.aiLodNearDistance)
+        return 1;
+    //It takes at least as many moves as the straight-line distance to reach the TunnelMan
+    if(p->getKind() == kindHardcoreProtestor && distanceSquared <= m_params.hardcoreTrackingMoves * m_params.hardcoreTrackingMoves)
+        return 1;
+    if(distanceSquared < m_params.aiLodFarDistance * m_params.aiLodFarDistance)
+        return m_params.aiLodMidStride;
+    return m_params.aiLodFarStride;
 }
 
-bool StudentWorld::squirtProtestorWithinRadius(int x, int y, int radius){
-    vector<Actor*> doomed = findProtestorsWithinRadius(x, y, radius);
-    if(doomed.size() != 0){
-        doomed[0]->annoy(2); //Allocate points in the protestor::annoy function
-        return true;
-    }
+int StudentWorld::annoyProtestorsWithinRadius(int x, int y, int radius, int howMuch, int maxProtestors){
+    //Find them all before annoying any (points are allocated in the protestor::annoy function)
+    ProtestorMatches matches;
+    int annoyed = findProtestorsWithinRadius(x, y, radius, matches);
+    if(maxProtestors > 0 && annoyed > maxProtestors)
+        annoyed = maxProtestors;
+    for(int i = 0; i < annoyed; i++)
+        matches.protestors[i]->annoy(howMuch);
+    if(!matches.truncated || annoyed == maxProtestors)
+        return annoyed;
     
-    return false;
+    //More of them than the buffer holds: annoying one doesn't move it or kill it, so a second search finds the same ones
+    //in the same order, and the rest can be annoyed as it comes to them
+    int skipped = 0;
+    forEachProtestorWithinRadius(x, y, radius, [&](Protestor* p){
+        if(skipped < matches.count){
+            skipped++;
+            return true;
+        }
+        p->annoy(howMuch);
+        annoyed++;
+        return annoyed != maxProtestors;
+    });
+    return annoyed;
 }
 
-bool StudentWorld::willHitBoulderOrEdge(int x, int y, GraphObject::Direction d){
+bool StudentWorld::willHitBoulderOrEdge(int x, int y, GraphObject::Direction d) const{
     
     if(d == GraphObject::up){
         if(!actorWouldBeWithinField(x, y+1))
@@ -282,7 +405,7 @@ bool StudentWorld::willHitBoulderOrEdge(int x, int y, GraphObject::Direction d){
     return false;
 }
 
-bool StudentWorld::willHitBoulderEdgeOrEarth(int x, int y, GraphObject::Direction d){
+bool StudentWorld::willHitBoulderEdgeOrEarth(int x, int y, GraphObject::Direction d) const{
     if(willHitBoulderOrEdge(x, y, d))
         return true;
     
@@ -306,71 +429,180 @@ bool StudentWorld::willHitBoulderEdgeOrEarth(int x, int y, GraphObject::Directio
     return false;
 }
 
-GraphObject::Direction StudentWorld::getDirectionToLocation(Actor* p, int xLoc, int yLoc){
-    int maze[VIEW_HEIGHT][VIEW_WIDTH];
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            maze[i][j] = 0;
-        }
-    }
-    bool visited[VIEW_HEIGHT][VIEW_WIDTH];
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            visited[i][j] = false;
-        }
-    }
+void StudentWorld::computeMazeDistances(MazeField& field, int startX, int startY) const{
+    field.distance.assign(static_cast<size_t>(m_fieldWidth) * m_fieldHeight, 0);
+    field.visited.assign(static_cast<size_t>(m_fieldWidth) * m_fieldHeight, false);
+    
     queue<mazeLocation> q;
-    q.push(mazeLocation(xLoc, yLoc));
+    q.push(mazeLocation(startX, startY));
     
     while(!q.empty()){
         mazeLocation current = q.front();
         q.pop();
         int x = current.x;
         int y = current.y;
+        int next = field.distance[mazeIndex(x, y)] + 1;
         
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::up) && !visited[y+1][x]){
-            visited[y+1][x] = true;
+        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::up) && !field.visited[mazeIndex(x, y+1)]){
+            field.visited[mazeIndex(x, y+1)] = true;
             q.push(mazeLocation(x, y+1));
-            maze[y+1][x] = maze[y][x] + 1;
+            field.distance[mazeIndex(x, y+1)] = next;
         }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::down) && !visited[y-1][x]){
-            visited[y-1][x] = true;
+        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::down) && !field.visited[mazeIndex(x, y-1)]){
+            field.visited[mazeIndex(x, y-1)] = true;
             q.push(mazeLocation(x, y-1));
-            maze[y-1][x] = maze[y][x] + 1;
+            field.distance[mazeIndex(x, y-1)] = next;
         }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::right) && !visited[y][x+1]){
-            visited[y][x+1] = true;
+        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::right) && !field.visited[mazeIndex(x+1, y)]){
+            field.visited[mazeIndex(x+1, y)] = true;
             q.push(mazeLocation(x+1, y));
-            maze[y][x+1] = maze[y][x] + 1;
+            field.distance[mazeIndex(x+1, y)] = next;
         }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::left) && !visited[y][x-1]){
-            visited[y][x-1] = true;
+        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::left) && !field.visited[mazeIndex(x-1, y)]){
+            field.visited[mazeIndex(x-1, y)] = true;
             q.push(mazeLocation(x-1, y));
-            maze[y][x-1] = maze[y][x] + 1;
+            field.distance[mazeIndex(x-1, y)] = next;
         }
     }
     
-    int protestorX = p->getX();
-    int protestorY = p->getY();
+    field.targetX = startX;
+    field.targetY = startY;
+    field.version = m_mazeVersion;
+    field.valid = true;
+}
+
+int StudentWorld::mazeDistance(const MazeField& field, int x, int y, int notValid) const{
+    if(inField(x, y) && field.visited[mazeIndex(x, y)])
+        return field.distance[mazeIndex(x, y)];
+    return notValid;
+}
+
+MazeField* StudentWorld::staleMazeFieldTo(int x, int y){
+    for(int i = 0; i < 2; i++){
+        MazeField& field = m_mazeFields[i];
+        if(field.valid && field.version == m_mazeVersion && field.targetX == x && field.targetY == y){
+            m_recentMazeField = i;
+            return nullptr;
+        }
+    }
+    //Reuse whichever slot was used less recently
+    m_recentMazeField = 1 - m_recentMazeField;
+    m_mazeFields[m_recentMazeField].valid = false;
+    return &m_mazeFields[m_recentMazeField];
+}
+
+const MazeField& StudentWorld::mazeFieldTo(int x, int y){
+    MazeField* stale = staleMazeFieldTo(x, y);
+    if(stale != nullptr)
+        computeMazeDistances(*stale, x, y);
+    return m_mazeFields[m_recentMazeField];
+}
+
+void StudentWorld::prepareMazeFields(){
+    //Protestors on their way out search from the exit, and hardcore ones that get a full turn search from the TunnelMan. Nothing
+    //a protestor does changes the maze, so unless a boulder falls in the meantime these answer every such search this tick
+    bool needExit = false;
+    bool needPlayer = false;
+    for(Protestor* p : m_protestors){
+        if(!p->getLiveStatus())
+            continue;
+        if(p->isLeavingOilField())
+            needExit = true;
+        else if(p->getKind() == kindHardcoreProtestor && p->willActThisTick() && protestorUpdateStride(p) == 1)
+            needPlayer = true;
+    }
     
-    const int notValid = 100;
-    int up = notValid;
-    int down = notValid;
-    int left = notValid;
-    int right = notValid;
+    int exitX = m_fieldWidth - actorSize;
+    int exitY = m_fieldHeight - actorSize;
+    int playerX = m_player->getX();
+    int playerY = m_player->getY();
+    MazeField* exitField = needExit ? staleMazeFieldTo(exitX, exitY) : nullptr;
+    MazeField* playerField = needPlayer ? staleMazeFieldTo(playerX, playerY) : nullptr;
     
-    if(inField(protestorX, protestorY+1) && visited[protestorY+1][protestorX]){
-        up = maze[protestorY+1][protestorX];
-    }
-    if(inField(protestorX, protestorY-1) && visited[protestorY-1][protestorX]){
-        down = maze[protestorY-1][protestorX];
+    MazeField* fields[2];
+    int targetXs[2];
+    int targetYs[2];
+    size_t numSearches = 0;
+    if(exitField != nullptr){
+        fields[numSearches] = exitField;
+        targetXs[numSearches] = exitX;
+        targetYs[numSearches++] = exitY;
     }
-    if(inField(protestorX+1, protestorY) && visited[protestorY][protestorX+1]){
-        right = maze[protestorY][protestorX+1];
+    if(playerField != nullptr){
+        fields[numSearches] = playerField;
+        targetXs[numSearches] = playerX;
+        targetYs[numSearches++] = playerY;
     }
-    if(inField(protestorX-1, protestorY) && visited[protestorY][protestorX-1]){
-        left = maze[protestorY][protestorX-1];
+    m_workers.run(numSearches, [&](size_t i){
+        computeMazeDistances(*fields[i], targetXs[i], targetYs[i]);
+    });
+}
+
+void StudentWorld::decideProtestorIntents(){
+    //Each protestor still acts on its intent in its own turn, in the usual order, so the tick plays out as if they were
+    //decided one at a time
+    m_protestorIntents.resize(m_protestors.size());
+    m_workers.run(m_protestors.size(), [this](size_t i){
+        const Protestor* p = m_protestors[i];
+        ProtestorIntent& intent = m_protestorIntents[i];
+        intent.valid = false;
+        if(!p->getLiveStatus())
+            return;
+        if(p->isLeavingOilField() || (p->willActThisTick() && protestorUpdateStride(p) == 1))
+            decideProtestorIntent(p, intent);
+    });
+}
+
+void StudentWorld::decideProtestorIntent(const Protestor* p, ProtestorIntent& intent) const{
+    intent.protestor = p;
+    intent.tick = m_tickNumber;
+    intent.x = p->getX();
+    intent.y = p->getY();
+    intent.playerX = m_player->getX();
+    intent.playerY = m_player->getY();
+    intent.mazeVersion = m_mazeVersion;
+    intent.leaving = p->isLeavingOilField();
+    p->decideIntent(intent);
+}
+
+const ProtestorIntent& StudentWorld::protestorIntentFor(const Protestor* p){
+    size_t i = p->getListIndex();
+    if(i >= m_protestorIntents.size())
+        m_protestorIntents.resize(m_protestors.size());
+    ProtestorIntent& intent = m_protestorIntents[i];
+    if(intent.valid && intent.protestor == p && intent.tick == m_tickNumber && intent.x == p->getX() && intent.y == p->getY() &&
+       intent.playerX == m_player->getX() && intent.playerY == m_player->getY() && intent.mazeVersion == m_mazeVersion &&
+       intent.leaving == p->isLeavingOilField())
+        return intent;
+    
+    //Woken early, or a boulder moved since: run the search it needs here and decide again
+    if(p->isLeavingOilField())
+        mazeFieldTo(m_fieldWidth - actorSize, m_fieldHeight - actorSize);
+    else if(p->getKind() == kindHardcoreProtestor)
+        mazeFieldTo(m_player->getX(), m_player->getY());
+    decideProtestorIntent(p, intent);
+    return intent;
+}
+
+size_t StudentWorld::mazeIndex(int x, int y) const{
+    return static_cast<size_t>(y) * m_fieldWidth + x;
+}
+
+const MazeField* StudentWorld::freshMazeFieldTo(int x, int y) const{
+    for(int i = 0; i < 2; i++){
+        const MazeField& field = m_mazeFields[i];
+        if(field.valid && field.version == m_mazeVersion && field.targetX == x && field.targetY == y)
+            return &field;
     }
+    return nullptr;
+}
+
+GraphObject::Direction StudentWorld::getDirectionOnField(const MazeField& field, int protestorX, int protestorY) const{
+    const int notValid = 100;
+    int up = mazeDistance(field, protestorX, protestorY+1, notValid);
+    int down = mazeDistance(field, protestorX, protestorY-1, notValid);
+    int right = mazeDistance(field, protestorX+1, protestorY, notValid);
+    int left = mazeDistance(field, protestorX-1, protestorY, notValid);
     
     int lowestDir = up;
     if(down < lowestDir)
@@ -391,112 +623,489 @@ GraphObject::Direction StudentWorld::getDirectionToLocation(Actor* p, int xLoc,
     
 }
 
-bool StudentWorld::isXMovesAwayFromTunnelMan(Actor *p, int movesAway){
-    int maze[VIEW_HEIGHT][VIEW_WIDTH];
+bool StudentWorld::isWithinMovesOnField(const MazeField& field, int protestorX, int protestorY, int movesAway) const{
+    const int notValid = 100;
+    int up = mazeDistance(field, protestorX, protestorY+1, notValid);
+    int down = mazeDistance(field, protestorX, protestorY-1, notValid);
+    int right = mazeDistance(field, protestorX+1, protestorY, notValid);
+    int left = mazeDistance(field, protestorX-1, protestorY, notValid);
     
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            maze[i][j] = 0;
-        }
-    }
-    bool visited[VIEW_HEIGHT][VIEW_WIDTH];
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            visited[i][j] = false;
-        }
-    }
-    queue<mazeLocation> q;
-    q.push(mazeLocation(m_player->getX(), m_player->getY()));
+    if(up < movesAway || down < movesAway || left < movesAway || right < movesAway)
+        return true;
+    else
+        return false; 
+}
+
+bool StudentWorld::getKey(int& value){
+    if(m_replaying)
+        return m_replay.nextKey(m_tickNumber, value);
     
-    while(!q.empty()){
-        mazeLocation current = q.front();
-        q.pop();
-        int x = current.x;
-        int y = current.y;
-        
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::up) && !visited[y+1][x]){
-            visited[y+1][x] = true;
-            q.push(mazeLocation(x, y+1));
-            maze[y+1][x] = maze[y][x] + 1;
-        }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::down) && !visited[y-1][x]){
-            visited[y-1][x] = true;
-            q.push(mazeLocation(x, y-1));
-            maze[y-1][x] = maze[y][x] + 1;
-        }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::right) && !visited[y][x+1]){
-            visited[y][x+1] = true;
-            q.push(mazeLocation(x+1, y));
-            maze[y][x+1] = maze[y][x] + 1;
-        }
-        if(!willHitBoulderEdgeOrEarth(x, y, GraphObject::left) && !visited[y][x-1]){
-            visited[y][x-1] = true;
-            q.push(mazeLocation(x-1, y));
-            maze[y][x-1] = maze[y][x] + 1;
-        }
+    bool gotKey = GameWorld::getKey(value);
+    if(gotKey)
+        m_recorder.recordKey(m_tickNumber, value);
+    return gotKey;
+}
+
+bool StudentWorld::startRecording(const string& path, unsigned int seed){
+    srand(seed);
+    InputLogSetup setup;
+    setup.fastRestart = m_fastRestart;
+    setup.aiLod = m_aiLod;
+    setup.fieldWidth = m_fieldWidth;
+    setup.fieldHeight = m_fieldHeight;
+    setup.paramsChecksum = levelParamsChecksum();
+    setup.levelFileChecksum = levelFileChecksum();
+    setup.startSnapshot = m_pendingSnapshot;
+    return m_recorder.open(path, seed, setup);
+}
+
+bool StudentWorld::startReplay(const string& path, string& problem){
+    if(!m_replay.load(path)){
+        problem = "it can't be read or is malformed";
+        return false;
     }
-    
-    int protestorX = p->getX();
-    int protestorY = p->getY();
-    
-    const int notValid = 100;
-    int up = notValid;
-    int down = notValid;
-    int left = notValid;
-    int right = notValid;
-    
-    if(inField(protestorX, protestorY+1) && visited[protestorY+1][protestorX]){
-        up = maze[protestorY+1][protestorX];
+    const InputLogSetup& setup = m_replay.getSetup();
+    if(!setup.startSnapshot.empty() && !isValidSnapshot(setup.startSnapshot)){
+        problem = "its starting snapshot is malformed";
+        return false;
     }
-    if(inField(protestorX, protestorY-1) && visited[protestorY-1][protestorX]){
-        down = maze[protestorY-1][protestorX];
+    //Only the checksums of the level settings and level file are kept, so the same ones have to be loaded already
+    if(setup.paramsChecksum != levelParamsChecksum()){
+        problem = "it was recorded with different level settings (--params)";
+        return false;
     }
-    if(inField(protestorX+1, protestorY) && visited[protestorY][protestorX+1]){
-        right = maze[protestorY][protestorX+1];
+    if(setup.levelFileChecksum != levelFileChecksum()){
+        problem = "it was recorded with a different level file (--level)";
+        return false;
     }
-    if(inField(protestorX-1, protestorY) && visited[protestorY][protestorX-1]){
-        left = maze[protestorY][protestorX-1];
+    if(!setFieldSize(setup.fieldWidth, setup.fieldHeight)){
+        problem = "it was recorded with an unsupported field size";
+        return false;
     }
+    m_pendingSnapshot = setup.startSnapshot;
+    setFastRestart(setup.fastRestart);
+    setAiLod(setup.aiLod);
+    srand(m_replay.getSeed());
+    m_replaying = true;
+    return true;
+}
+
+bool StudentWorld::replayFinished() const{
+    return m_replaying && m_tickNumber >= m_replay.getResults().finalTick;
+}
+
+const InputLogResults& StudentWorld::getReplayResults() const{
+    return m_replay.getResults();
+}
+
+void StudentWorld::saveSnapshot(vector<char>& image) const{
+    uint32_t numActors = static_cast<uint32_t>(m_gameObjects.size()) + 1;
+    image.assign(sizeof(SnapshotHeader) + m_earth.numWords() * sizeof(uint64_t) + numActors * sizeof(ActorRecord), 0);
     
-    if(up < movesAway || down < movesAway || left < movesAway || right < movesAway)
-        return true;
-    else
-        return false; 
+    SnapshotHeader* header = reinterpret_cast<SnapshotHeader*>(image.data());
+    copy(snapshotMagic, snapshotMagic + sizeof(snapshotMagic), header->magic);
+    header->version = snapshotVersion;
+    header->fieldWidth = m_fieldWidth;
+    header->fieldHeight = m_fieldHeight;
+    header->level = getLevel();
+    header->lives = getLives();
+    header->score = getScore();
+    header->numBarrels = m_numBarrels;
+    header->minTicksBetweenProtestors = m_minTicksBetweenProtestors;
+    header->ticksSinceLastProtestorAdded = m_ticksSinceLastProtestorAdded;
+    header->numProtestors = m_numProtestors;
+    header->numActors = numActors;
+    
+    uint64_t* earthRows = reinterpret_cast<uint64_t*>(header + 1);
+    m_earth.copyWords(earthRows);
+    
+    ActorRecord* records = reinterpret_cast<ActorRecord*>(earthRows + m_earth.numWords());
+    m_player->saveState(records[0]);
+    for(size_t i = 0; i < m_gameObjects.size(); i++)
+        m_gameObjects[i]->saveState(records[i+1]);
+}
+
+bool StudentWorld::saveSnapshotToFile(const string& path) const{
+    vector<char> image;
+    saveSnapshot(image);
+    ofstream file(path, ios::out | ios::binary | ios::trunc);
+    return file.write(image.data(), image.size()).good();
+}
+
+bool StudentWorld::loadSnapshotFromFile(const string& path){
+    ifstream file(path, ios::in | ios::binary | ios::ate);
+    if(!file)
+        return false;
+    vector<char> image(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if(!file.read(image.data(), image.size()) || !isValidSnapshot(image))
+        return false;
+    m_pendingSnapshot.swap(image);
+    return true;
+}
+
+void StudentWorld::setLevelStartSnapshotFile(const string& path){
+    m_levelStartSnapshotFile = path;
+}
+
+void StudentWorld::setLevelFile(const string& path){
+    m_levelFilePath = path;
+    m_levelFile.close();
+}
+
+void StudentWorld::setLevelExportFile(const string& path){
+    m_levelExportFile = path;
+}
+
+bool StudentWorld::loadLevelParams(const string& path){
+    return m_paramOverrides.load(path);
+}
+
+void StudentWorld::setFastRestart(bool enabled){
+    m_fastRestart = enabled;
+    if(!enabled)
+        m_levelStartSnapshot.clear();
+}
+
+void StudentWorld::setAiLod(bool enabled){
+    m_aiLod = enabled;
+}
+
+void StudentWorld::enableTimeline(size_t memoryBudget, unsigned int keyframeInterval){
+    m_timeline.configure(memoryBudget, keyframeInterval);
+}
+
+const WorldTimeline& StudentWorld::getTimeline() const{
+    return m_timeline;
+}
+
+bool StudentWorld::seekToTick(unsigned int tick){
+    vector<char> image;
+    if(!m_timeline.seek(tick, image) || !isValidSnapshot(image))
+        return false;
+    
+    cleanUp();
+    //Let the old actors go before the restored ones appear, so only the restored world is registered when this returns
+    m_reclaimer.waitUntilIdle();
+    //Restored actors put what's left of their waits back on the timing wheel, so it has to count from the right tick first
+    m_tickNumber = tick - 1;
+    m_wheel.reset(m_tickNumber);
+    restoreSnapshot(image, true);
+    m_displayedStatsValid = false;
+    return true;
 }
 
 void StudentWorld::bribeProtestor(int x, int y, int radius){
-    vector<Actor*> protestor = findProtestorsWithinRadius(x, y, radius);
-    if(protestor.size() == 0)
+    Protestor* protestor = findProtestorWithinRadius(x, y, radius);
+    if(protestor == nullptr)
         return;
     
-    protestor[0]->bribe();
+    protestor->bribe();
 }
 
 //Private Function Implementations
+
+unsigned int StudentWorld::levelParamsChecksum() const{
+    const string& source = m_paramOverrides.getSource();
+    if(source.empty())
+        return 0;
+    return inputLogChecksum(source.data(), source.size());
+}
+
+unsigned int StudentWorld::levelFileChecksum(){
+    if(m_levelFilePath.empty() || (!m_levelFile.isOpen() && !m_levelFile.open(m_levelFilePath)))
+        return 0;
+    return inputLogChecksum(m_levelFile.data(), m_levelFile.size());
+}
+
+bool StudentWorld::isValidSnapshot(const vector<char>& image) const{
+    if(image.size() < sizeof(SnapshotHeader))
+        return false;
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(image.data());
+    if(!equal(snapshotMagic, snapshotMagic + sizeof(snapshotMagic), header->magic) || header->version != snapshotVersion)
+        return false;
+    if(header->fieldWidth > static_cast<uint32_t>(maxFieldSize) || header->fieldHeight > static_cast<uint32_t>(maxFieldSize) ||
+       !isValidFieldSize(header->fieldWidth, header->fieldHeight) || header->numActors == 0)
+        return false;
+    if(image.size() != snapshotSize(*header))
+        return false;
+    
+    const ActorRecord* records = reinterpret_cast<const ActorRecord*>(image.data() + sizeof(SnapshotHeader) + snapshotEarthWords(*header) * sizeof(uint64_t));
+    if(records[0].gameID != 'T')
+        return false;
+    for(uint32_t i = 0; i < header->numActors; i++){
+        if(records[i].x < 0 || records[i].x > static_cast<int>(header->fieldWidth) - actorSize ||
+           records[i].y < 0 || records[i].y > static_cast<int>(header->fieldHeight) - actorSize)
+            return false;
+    }
+    return true;
+}
+
+void StudentWorld::restoreSnapshot(const vector<char>& image, bool includeStats){
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(image.data());
+    const uint64_t* earthRows = reinterpret_cast<const uint64_t*>(header + 1);
+    const ActorRecord* records = reinterpret_cast<const ActorRecord*>(earthRows + snapshotEarthWords(*header));
+    
+    if(includeStats)
+        restoreStats(header->level, header->lives, header->score);
+    m_params = paramsForLevel(getLevel());
+    m_numBarrels = header->numBarrels;
+    m_minTicksBetweenProtestors = header->minTicksBetweenProtestors;
+    m_ticksSinceLastProtestorAdded = header->ticksSinceLastProtestorAdded;
+    m_numProtestors = header->numProtestors;
+    
+    setFieldSize(header->fieldWidth, header->fieldHeight);
+    m_earth.setWords(earthRows);
+    m_freeCells.rebuild(m_earth);
+    m_mazeVersion++;
+    
+    //The TunnelMan goes first since squirts take their direction from him
+    m_player = new TunnelMan(this);
+    m_player->restoreState(records[0]);
+    updateCamera();
+    for(uint32_t i = 1; i < header->numActors; i++){
+        Actor* a = createActorFromRecord(records[i]);
+        if(a == nullptr)
+            continue;
+        a->restoreState(records[i]);
+        addActor(a);
+    }
+}
+
+Actor* StudentWorld::createActorFromRecord(const ActorRecord& r){
+    switch(r.gameID){
+        case 'B': return new Boulder(this, r.x, r.y);
+        case 'O': return new Barrel(this, r.x, r.y);
+        case 'W': return new WaterPool(this, r.x, r.y);
+        case 'K': return new SonarKit(this);
+        case 'G': return new Gold(this, r.x, r.y, r.state[0] != 0);
+        case 'S': return new Squirt(this, r.x, r.y);
+        case 'p': return new RegularProtestor(this);
+        case 'P': return new HardcoreProtestor(this);
+        default: return nullptr;
+    }
+}
                
-double StudentWorld::distanceApart(int x, int y, int x2, int y2) const {
+int StudentWorld::squaredDistance(int x, int y, int x2, int y2) const {
+    //Comparing squared distances against squared radii gives the same answers as comparing distances, without a sqrt
     int diffX = x2 - x;
     int diffY = y2 - y;
-    int total = diffX * diffX + diffY * diffY;
-    return sqrt(total);
+    return diffX * diffX + diffY * diffY;
 }
 
 void StudentWorld::addActor(Actor* a){
+    a->setUpdateIndex(static_cast<int>(m_gameObjects.size()));
     m_gameObjects.push_back(a);
+    m_turnKinds.push_back(static_cast<uint8_t>(a->getKind()));
+    m_turnFlags.push_back(turnFlagsOf(a));
+    if(a->getKind() == kindBoulder){
+        a->setListIndex(static_cast<int>(m_boulders.size()));
+        m_boulders.push_back(static_cast<Boulder*>(a));
+        m_boulderPositions.add(a->getX(), a->getY());
+        m_mazeVersion++;
+    }
+    else if(a->isProtestor()){
+        a->setListIndex(static_cast<int>(m_protestors.size()));
+        m_protestors.push_back(static_cast<Protestor*>(a));
+        m_protestorPositions.add(a->getX(), a->getY());
+    }
+    else if(a->isGoodie() && static_cast<Goodie*>(a)->canBePickedUp())
+        goodieBucketAt(a->getX(), a->getY()).push_back(static_cast<Goodie*>(a));
 }
 
 
 void StudentWorld::removeActor(Actor* a){
-    vector<Actor*>::iterator it;
-    it = m_gameObjects.begin();
-    while(it != m_gameObjects.end()){
-        if(*it == a){
-            delete *it;
-            it = m_gameObjects.erase(it);
+    m_wheel.cancel(a->getTimer());
+    if(a->getKind() == kindBoulder){
+        eraseFromList(m_boulders, m_boulderPositions, a->getListIndex());
+        m_mazeVersion++;
+        wakeBouldersAbove(a->getX(), a->getY(), a->getX() + actorSize, a->getY() + actorSize);
+    }
+    else if(a->isGoodie())
+        unfileGoodie(static_cast<Goodie*>(a));
+    else if(a->isProtestor())
+        eraseFromList(m_protestors, m_protestorPositions, a->getListIndex());
+    
+    size_t i = a->getUpdateIndex();
+    m_gameObjects.erase(m_gameObjects.begin() + i);
+    m_turnKinds.erase(m_turnKinds.begin() + i);
+    m_turnFlags.erase(m_turnFlags.begin() + i);
+    for(size_t j = i; j < m_gameObjects.size(); j++)
+        m_gameObjects[j]->setUpdateIndex(static_cast<int>(j));
+    delete a;
+}
+
+void StudentWorld::removeDeadActors(){
+    //Take the dead out of the category lists while they can still be asked, then delete them
+    size_t numBoulders = m_boulders.size();
+    for(Boulder* b : m_boulders){
+        if(!b->getLiveStatus())
+            wakeBouldersAbove(b->getX(), b->getY(), b->getX() + actorSize, b->getY() + actorSize);
+    }
+    removeDeadFromList(m_boulders, m_boulderPositions);
+    if(m_boulders.size() != numBoulders)
+        m_mazeVersion++;
+    removeDeadFromList(m_protestors, m_protestorPositions);
+    
+    size_t kept = 0;
+    for(size_t i = 0; i < m_gameObjects.size(); i++){
+        Actor* a = m_gameObjects[i];
+        if(m_turnFlags[i] & turnAlive){
+            a->setUpdateIndex(static_cast<int>(kept));
+            m_turnKinds[kept] = m_turnKinds[i];
+            m_turnFlags[kept] = m_turnFlags[i];
+            m_gameObjects[kept++] = a;
+            continue;
         }
-        else{
-            it++;
+        if(a->isGoodie())
+            unfileGoodie(static_cast<Goodie*>(a));
+        m_wheel.cancel(a->getTimer());
+        delete a;
+    }
+    m_gameObjects.resize(kept);
+    m_turnKinds.resize(kept);
+    m_turnFlags.resize(kept);
+}
+
+bool StudentWorld::isLiveProtestor(size_t i) const{
+    return m_protestors[i]->getLiveStatus();
+}
+
+void StudentWorld::actorMoved(Actor* a){
+    if(a->getKind() == kindBoulder){
+        int oldX = m_boulderPositions.x(a->getListIndex());
+        int oldY = m_boulderPositions.y(a->getListIndex());
+        m_boulderPositions.set(a->getListIndex(), a->getX(), a->getY());
+        m_mazeVersion++;
+        wakeBouldersAbove(oldX, oldY, oldX + actorSize, oldY + actorSize);
+    }
+    else if(a->isProtestor())
+        m_protestorPositions.set(a->getListIndex(), a->getX(), a->getY());
+}
+
+void StudentWorld::actorTurnStateChanged(Actor* a){
+    if(a->getUpdateIndex() >= 0)
+        m_turnFlags[a->getUpdateIndex()] = turnFlagsOf(a);
+}
+
+void StudentWorld::triggerGoodiesNear(int x, int y){
+    int left = max(x - goodieRevealRadius, 0) / goodieBucketSize;
+    int right = min(x + goodieRevealRadius, m_fieldWidth - 1) / goodieBucketSize;
+    int bottom = max(y - goodieRevealRadius, 0) / goodieBucketSize;
+    int top = min(y + goodieRevealRadius, m_fieldHeight - 1) / goodieBucketSize;
+    for(int by = bottom; by <= top; by++){
+        for(int bx = left; bx <= right; bx++){
+            for(Goodie* g : m_goodieBuckets[by * m_goodieBucketsWide + bx]){
+                if(squaredDistance(x, y, g->getX(), g->getY()) <= goodieRevealRadius * goodieRevealRadius)
+                    g->setTriggered(true);
+            }
+        }
+    }
+}
+
+vector<Goodie*>& StudentWorld::goodieBucketAt(int x, int y){
+    return m_goodieBuckets[(y / goodieBucketSize) * m_goodieBucketsWide + x / goodieBucketSize];
+}
+
+void StudentWorld::unfileGoodie(Goodie* g){
+    if(!g->canBePickedUp())
+        return;
+    vector<Goodie*>& bucket = goodieBucketAt(g->getX(), g->getY());
+    bucket.erase(remove(bucket.begin(), bucket.end(), g), bucket.end());
+}
+
+unsigned int StudentWorld::getTickNumber() const{
+    return m_tickNumber;
+}
+
+void StudentWorld::scheduleWakeUp(Actor* a, unsigned int tick){
+    m_wheel.schedule(a->getTimer(), tick);
+    actorTurnStateChanged(a);
+}
+
+void StudentWorld::cancelWakeUp(Actor* a){
+    m_wheel.cancel(a->getTimer());
+    actorTurnStateChanged(a);
+}
+
+bool StudentWorld::hasHadTurnThisTick(const Actor* a) const{
+    if(m_turnsTaken == 0)
+        return false;
+    if(m_turnsTaken >= m_gameObjects.size())
+        return true;
+    return a->getUpdateIndex() >= 0 && static_cast<size_t>(a->getUpdateIndex()) < m_turnsTaken;
+}
+
+void StudentWorld::wakeBouldersAbove(int left, int bottom, int right, int top){
+    //A stable boulder only starts to fall once the 4x1 strip under it opens up
+    for(size_t i = 0; i < m_boulders.size(); i++){
+        int stripLeft = m_boulderPositions.x(i);
+        int stripY = m_boulderPositions.y(i) - 1;
+        if(stripY >= bottom && stripY < top && stripLeft < right && stripLeft + actorSize > left)
+            m_boulders[i]->signal(eventGroundOpenedBelow);
+    }
+}
+
+uint8_t StudentWorld::turnFlagsOf(Actor* a) const{
+    uint8_t flags = 0;
+    if(a->getLiveStatus())
+        flags |= turnAlive;
+    if(a->isSuspended())
+        flags |= turnWaiting;
+    if(a->isGoodie()){
+        Goodie* g = static_cast<Goodie*>(a);
+        if(g->isTriggered())
+            flags |= turnTriggered;
+        if(g->isTemporary())
+            flags |= turnTemporary;
+    }
+    return flags;
+}
+
+bool StudentWorld::wantsTurn(size_t i) const{
+    uint8_t flags = m_turnFlags[i];
+    if(!(flags & turnAlive))
+        return false;
+    switch(m_turnKinds[i]){
+        case kindBoulder:
+        case kindRegularProtestor:
+        case kindHardcoreProtestor:
+            return !(flags & turnWaiting);
+        case kindBarrel:
+        case kindWaterPool:
+        case kindSonarKit:
+        case kindGold:
+            //A goodie acts when the TunnelMan comes near, or to count down its lifetime while it isn't asleep
+            return (flags & turnTriggered) || ((flags & turnTemporary) && !(flags & turnWaiting));
+        default:
+            return true;
+    }
+}
+
+void StudentWorld::updateActor(Actor* a){
+    switch(a->getKind()){
+        case kindTunnelMan:
+            static_cast<TunnelMan*>(a)->TunnelMan::doSomething();
+            break;
+        case kindBoulder:
+        case kindRegularProtestor:
+        case kindHardcoreProtestor:
+            //The timing wheel and world events decide when these are ready; their turn runs the behavior coroutine on to
+            //its next co_await
+            a->resumeBehavior();
+            break;
+        case kindBarrel:
+        case kindWaterPool:
+        case kindSonarKit:
+        case kindGold:{
+            Goodie* g = static_cast<Goodie*>(a);
+            g->setTriggered(false);
+            g->Goodie::doSomething();
+            break;
         }
+        case kindSquirt:
+            static_cast<Squirt*>(a)->Squirt::doSomething();
+            break;
     }
 }
 
@@ -505,180 +1114,319 @@ TunnelMan* StudentWorld::getTunnelMan() const{
     return m_player;
 }
 
+const LevelParams& StudentWorld::getLevelParams() const{
+    return m_params;
+}
+
 
 
 bool StudentWorld::inField(int x, int y) const{
-    if(x < 0 || x >= VIEW_WIDTH)
+    if(x < 0 || x >= m_fieldWidth)
         return false;
-    if(y < 0 || y >= VIEW_HEIGHT)
+    if(y < 0 || y >= m_fieldHeight)
         return false;
     return true;
 }
 
 bool StudentWorld::actorWouldBeWithinField(int x, int y)const{
-    if(x < 0 || (x+actorSize) > VIEW_WIDTH)
+    if(x < 0 || (x+actorSize) > m_fieldWidth)
         return false;
-    if (y < 0 || (y+actorSize) > VIEW_HEIGHT)
+    if (y < 0 || (y+actorSize) > m_fieldHeight)
         return false;
     return true;
 }
 
-//Private StudentWorld Functions
-void StudentWorld::populateFieldWithEarth(){
-    //set earth tracker to have all nullptrs:
-    for(int i = 0; i < VIEW_HEIGHT; i++){
-        for(int j = 0; j < VIEW_WIDTH; j++){
-            m_earthTracker[i][j] = nullptr;
-        }
-    }
-    Earth* temp;
-    //fill rows 0 through 59 of the oil field with Earth Objects (with exception of vertical shafts)
-    for(int col = 0; col < VIEW_WIDTH; col++){
-        for(int row = 0; row < VIEW_HEIGHT-actorSize; row++){
-            //If the current location falls outside of the central tunnel
-            if((col < 30 || col > 33) || row < 4) {
-                temp = new Earth(this, col, row); //Create a new earth at the given location
-                m_earthTracker[row][col] = temp; //Add the earth pointer to the earthTracker
-            }
-        }
-    }
+bool StudentWorld::setFieldSize(int width, int height){
+    if(!isValidFieldSize(width, height))
+        return false;
+    m_fieldWidth = width;
+    m_fieldHeight = height;
+    m_goodieBucketsWide = (width + goodieBucketSize - 1) / goodieBucketSize;
+    m_goodieBuckets.assign(static_cast<size_t>(m_goodieBucketsWide) * ((height + goodieBucketSize - 1) / goodieBucketSize), vector<Goodie*>());
+    m_earth.resize(width, height);
+    m_freeCells.rebuild(m_earth);
+    m_mazeVersion++;
+    return true;
 }
 
-void StudentWorld::populateFieldWithBoulders(){
-    int numBoulders = fmin(getLevel() / 2 + 2, 9);
-    
-    for(int i = 0; i < numBoulders; i++){
-        int x, y;
-        do{
-            x = rand() % 54 + 1;
-            y = rand() % 35 + 20;
-        }while(thereAreObjectsTooClose(x, y) || nearTunnel(x, y));
-        
-        Boulder* b = new Boulder(this, x, y);
-        addActor(b);
-    }
+int StudentWorld::getFieldWidth() const{
+    return m_fieldWidth;
 }
 
-void StudentWorld::populateFieldWithNuggets(){
-    int numNuggets = fmax(2, 5 - getLevel()/2);
+int StudentWorld::getFieldHeight() const{
+    return m_fieldHeight;
+}
 
-    for(int i = 0; i < numNuggets; i++){
-        int x, y;
-        do{
-            x = rand() % 60;
-            y = rand() % 56;
-        }while(thereAreObjectsTooClose(x, y));
+void StudentWorld::getViewOrigin(int& x, int& y) const{
+    x = m_viewX;
+    y = m_viewY;
+}
 
-        Gold* g = new Gold(this, x, y, true);
-        addActor(g);
-    }
+//Private StudentWorld Functions
+LevelParams StudentWorld::paramsForLevel(int level) const{
+    LevelParams params = standardLevelParams(level);
+    m_paramOverrides.apply(level, params);
+    return params;
 }
 
-void StudentWorld::populateFieldWithBarrels(){
-    int numBarrels = fmin(21, 2 + getLevel()); 
+void StudentWorld::prepareNextLevel(){
+    //The seed is drawn here, on the game thread, so the random sequence (and so any recorded session) is the same as
+    //when the layout was generated inside init()
+    if(!m_levelFilePath.empty())
+        return; //every level comes from the level file
+    
+    int level = getLevel() + 1;
+    LevelParams params = paramsForLevel(level);
+    int width = m_fieldWidth;
+    int height = m_fieldHeight;
+    unsigned int seed = rand();
+    m_nextLayout = async(launch::async, [level, params, width, height, seed](){
+        LevelLayout layout;
+        generateLevelLayout(level, params, width, height, seed, layout);
+        return layout;
+    });
+}
 
-    m_numBarrels = numBarrels;
+bool StudentWorld::takeLevelLayout(LevelLayout& layout){
+    if(!m_levelFilePath.empty()){
+        if(!m_levelFile.isOpen() && !m_levelFile.open(m_levelFilePath))
+            return false;
+        m_levelFile.getLayout(getLevel(), layout);
+        return true;
+    }
+    
+    bool prepared = false;
+    if(m_nextLayout.valid()){
+        layout = m_nextLayout.get();
+        prepared = layout.level == static_cast<int>(getLevel());
+    }
+    if(!prepared)
+        generateLevelLayout(getLevel(), m_params, m_fieldWidth, m_fieldHeight, rand(), layout);
+    if(!m_levelExportFile.empty() && !writeLevelFile(m_levelExportFile, layout))
+        cout << "Cannot write level file " << m_levelExportFile << endl;
+    return true;
+}
 
-    for(int i = 0; i < numBarrels; i++){
-        int x, y;
-        do{
-            x = rand() & 60;
-            y = rand() % 56;
-        }while(thereAreObjectsTooClose(x, y));
+void StudentWorld::populateFieldWithEarth(const EarthField& earth){
+    //all but the top four rows of the oil field are earth (with exception of the vertical shaft and the boulders)
+    if(earth.width() != m_fieldWidth || earth.height() != m_fieldHeight)
+        setFieldSize(earth.width(), earth.height());
+    m_earth = earth;
+    m_freeCells.rebuild(m_earth);
+    m_mazeVersion++;
+}
 
+void StudentWorld::updateCamera(){
+    //Keep the TunnelMan in the middle of the screen, without looking past the edges of the field
+    m_viewX = max(0, min(m_player->getX() + actorSize/2 - VIEW_WIDTH/2, m_fieldWidth - VIEW_WIDTH));
+    m_viewY = max(0, min(m_player->getY() + actorSize/2 - VIEW_HEIGHT/2, m_fieldHeight - VIEW_HEIGHT));
+}
 
-        Barrel* o = new Barrel(this, x, y);
-        addActor(o);
+void StudentWorld::populateFieldWithBoulders(const vector<FieldPosition>& positions){
+    for(const FieldPosition& p : positions){
+        Boulder* b = new Boulder(this, p.x, p.y);
+        addActor(b);
     }
 }
 
-bool StudentWorld::thereAreObjectsTooClose(int x, int y){
-    vector<Actor*>::iterator it;
-    for(it = m_gameObjects.begin(); it != m_gameObjects.end(); it++)
-    {
-        if(distanceApart(x, y, (*it)->getX(), (*it)->getY()) <= 6)
-            return true;
+void StudentWorld::populateFieldWithNuggets(const vector<FieldPosition>& positions){
+    for(const FieldPosition& p : positions){
+        Gold* g = new Gold(this, p.x, p.y, true);
+        addActor(g);
     }
-    return false;
 }
 
-bool StudentWorld::playerCompletedLevel(){
-    return m_player->getNumBarrelsFound() == m_numBarrels;
+void StudentWorld::populateFieldWithBarrels(const vector<FieldPosition>& positions){
+    //Every barrel the layout managed to place has to be found to finish the level
+    m_numBarrels = static_cast<int>(positions.size());
+
+    for(const FieldPosition& p : positions){
+        Barrel* o = new Barrel(this, p.x, p.y);
+        addActor(o);
+    }
 }
 
-bool StudentWorld::nearTunnel(int x, int y) const{
-    if((x >= 26 && x <= 34) && (y >= 4))
-        return true;
-    else
-        return false;
+bool StudentWorld::playerCompletedLevel(){
+    return m_player->getNumBarrelsFound() == m_numBarrels;
 }
 
 void StudentWorld::updateDisplayText(){
-    int level = getLevel();
-    int lives = getLives();
-    int health = m_player->getHitPoints() * 10;
-    int squirts = m_player->getNumSquirts();
-    int gold = m_player->getNumNuggets();
-    int barrelsLeft = m_numBarrels - m_player->getNumBarrelsFound();
-    int sonar = m_player->getNumSonarCharges();
-    int score = getScore();
-    // Next, create a string from your statistics, of the form: // Lvl: 52 Lives: 3 Hlth: 80% Wtr: 20 Gld: 3 Oil Left: 2 Sonar: 1 Scr: 321000
-    string s = formatStats(level, lives, health, squirts, gold, barrelsLeft, sonar, score);
-    // Finally, update the display text at the top of the screen with your // newly created stats
-    setGameStatText(s); // calls our provided GameWorld::setGameStatText
-}
-
-string StudentWorld::formatStats(int level, int lives, int health, int squirts, int gold, int barrelsLeft, int sonar, int score){
-    string flevel;
-    string flives;
-    string fhealth;
-    string fsquirts;
-    string fgold;
-    string fbarrelsLeft;
-    string fsonar;
-    string fscore;
-    
-    if(level / 10 == 0)
-        flevel = " " + to_string(level);
-    else
-        flevel = to_string(level);
+    int stats[numDisplayedStats] = {
+        static_cast<int>(getLevel()),
+        static_cast<int>(getLives()),
+        m_player->getHitPoints() * 10,
+        m_player->getNumSquirts(),
+        m_player->getNumNuggets(),
+        m_numBarrels - m_player->getNumBarrelsFound(),
+        m_player->getNumSonarCharges(),
+        static_cast<int>(getScore())
+    };
     
-    flives = to_string(lives);
-    fhealth = to_string(health) + "%";
+    //Only reformat (and hand new text to the HUD) when one of the stats actually changed
+    if(m_displayedStatsValid && equal(stats, stats + numDisplayedStats, m_displayedStats))
+        return;
     
-    if(squirts / 10 == 0)
-        fsquirts = " " + to_string(squirts);
-    else
-        fsquirts = to_string(squirts);
+    copy(stats, stats + numDisplayedStats, m_displayedStats);
+    m_displayedStatsValid = true;
     
-    if(gold / 10 == 0)
-        fgold = " " + to_string(gold);
-    else
-        fgold = to_string(gold);
-    
-    if(barrelsLeft / 10 == 0)
-        fbarrelsLeft = " " + to_string(barrelsLeft);
-    else
-        fbarrelsLeft = to_string(barrelsLeft);
+    formatStats(stats[0], stats[1], stats[2], stats[3], stats[4], stats[5], stats[6], stats[7]);
+    setGameStatText(m_statText); // calls our provided GameWorld::setGameStatText
+}
+
+void StudentWorld::formatStats(int level, int lives, int health, int squirts, int gold, int barrelsLeft, int sonar, int score){
+    //Of the form: Lvl: 52 Lives: 3 Hlth: 80% Wtr: 20 Gld: 3 Oil Left: 2 Sonar: 1 Scr: 321000
+    snprintf(m_statText, statTextCapacity, "Lvl: %2d Lives: %d Hlth: %d%% Wtr: %2d Gld: %2d Oil Left: %2d Sonar: %2d Scr: %06d",
+             level, lives, health, squirts, gold, barrelsLeft, sonar, score);
+}
+
+
+GameWorld* createStudentWorld(string assetDir, const WorldOptions& options)
+{
+    StudentWorld* world = new StudentWorld(assetDir);
+    if(!world->setFieldSize(options.fieldWidth, options.fieldHeight))
+        cout << "Unsupported field size " << options.fieldWidth << "x" << options.fieldHeight << "; using the standard one" << endl;
+    if(!options.levelParamsFile.empty() && !world->loadLevelParams(options.levelParamsFile))
+        cout << "Cannot load level settings " << options.levelParamsFile << "; using the standard ones" << endl;
+    if(!options.loadSnapshotFile.empty() && !world->loadSnapshotFromFile(options.loadSnapshotFile))
+        cout << "Cannot load snapshot " << options.loadSnapshotFile << "; generating a new level instead" << endl;
+    world->setFastRestart(options.fastRestart);
+    world->setLevelFile(options.levelFile);
+    world->setAiLod(options.aiLod);
+    if(!options.recordFile.empty() && !world->startRecording(options.recordFile, options.seed))
+        cout << "Cannot create input log " << options.recordFile << "; this session won't be recorded" << endl;
+    world->setLevelStartSnapshotFile(options.saveSnapshotFile);
+    world->setLevelExportFile(options.saveLevelFile);
+    if(options.timelineBudget > 0)
+        world->enableTimeline(options.timelineBudget, options.keyframeInterval);
+    return world;
+}
+
+//Plays an input log back through init()/move() with no window, as fast as possible, and checks that the session
+//ends with the recorded level, lives and score. Returns 0 if it does
+//The field size and AI level of detail come from the log; the level settings and level file must be the recorded ones
+//With a timeline enabled, it then seeks back to options.seekTick and reports how long that took
+int replayStudentWorld(string assetDir, string logFile, const WorldOptions& options)
+{
+    StudentWorld world(assetDir);
+    if(!options.levelParamsFile.empty() && !world.loadLevelParams(options.levelParamsFile)){
+        cout << "Cannot load level settings " << options.levelParamsFile << endl;
+        return 1;
+    }
+    world.setLevelFile(options.levelFile);
+    string problem;
+    if(!world.startReplay(logFile, problem)){
+        cout << "Cannot replay input log " << logFile << ": " << problem << endl;
+        return 1;
+    }
+    if(options.timelineBudget > 0)
+        world.enableTimeline(options.timelineBudget, options.keyframeInterval);
     
-    if(sonar / 10 == 0)
-        fsonar = " " + to_string(sonar);
-    else
-        fsonar = to_string(sonar);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    unsigned int ticks = 0;
+    int status = world.init();
+    while(status != GWSTATUS_LEVEL_ERROR && !world.replayFinished()){
+        status = world.move();
+        ticks++;
+        if(status == GWSTATUS_PLAYER_DIED){
+            if(world.isGameOver())
+                break;
+            world.cleanUp();
+            status = world.init();
+        }
+        else if(status == GWSTATUS_FINISHED_LEVEL){
+            world.advanceToNextLevel();
+            world.cleanUp();
+            status = world.init();
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    unsigned int finalLevel = world.getLevel(), finalLives = world.getLives(), finalScore = world.getScore();
     
-    int nDigits = to_string(score).size();
-    int spacesToAdd = 6 - nDigits;
-    for(int i = 0; i < spacesToAdd; i++){
-        fscore += "0";
+    if(options.seekTick > 0){
+        const WorldTimeline& timeline = world.getTimeline();
+        chrono::steady_clock::time_point seekStart = chrono::steady_clock::now();
+        if(world.seekToTick(options.seekTick)){
+            double seekMs = chrono::duration<double, milli>(chrono::steady_clock::now() - seekStart).count();
+            cout << "Sought to tick " << options.seekTick << " in " << seekMs << " ms: level " << world.getLevel()
+                 << ", lives " << world.getLives() << ", score " << world.getScore() << endl;
+        }
+        else
+            cout << "Tick " << options.seekTick << " isn't in the timeline (ticks " << timeline.oldestTick() << "-"
+                 << timeline.newestTick() << ", " << timeline.memoryUsed() / 1024 << " KB)" << endl;
     }
-    fscore += to_string(score);
+    world.cleanUp();
     
+    const InputLogResults& expected = world.getReplayResults();
+    cout << "Replayed " << ticks << " ticks in " << seconds * 1000 << " ms";
+    if(seconds > 0)
+        cout << " (" << ticks / seconds << " ticks/sec)";
+    cout << endl;
     
-    return "Lvl: " + flevel + " Lives: " + flives + " Hlth: " + fhealth +  " Wtr: " + fsquirts + " Gld: " + fgold + " Oil Left: " + fbarrelsLeft + " Sonar: " + fsonar + " Scr: " + fscore;
+    if(finalLevel != expected.level || finalLives != expected.lives || finalScore != expected.score){
+        cout << "Replay diverged: expected level " << expected.level << ", lives " << expected.lives << ", score " << expected.score
+             << " but got level " << finalLevel << ", lives " << finalLives << ", score " << finalScore << endl;
+        return 2;
+    }
+    cout << "Replay matched: level " << expected.level << ", lives " << expected.lives << ", score " << expected.score << endl;
+    return 0;
 }
 
-
-GameWorld* createStudentWorld(string assetDir)
+//Plays options.benchAiTicks ticks with no window and no key presses (starting a new game whenever the TunnelMan runs out
+//of lives), once with AI level of detail off and once with it on, from the same seed, and reports how long each took.
+//Returns 0 unless a world can't be set up
+int benchStudentWorld(string assetDir, const WorldOptions& options)
 {
-    return new StudentWorld(assetDir);
+    const unsigned int benchSeed = 1;
+    double msPerTick[2] = {0, 0};
+    for(int lod = 0; lod < 2; lod++){
+        srand(benchSeed);
+        unsigned int ticks = 0;
+        unsigned int games = 0;
+        double ms = 0;
+        while(ticks < options.benchAiTicks){
+            StudentWorld world(assetDir);
+            if(!world.setFieldSize(options.fieldWidth, options.fieldHeight)){
+                cout << "Unsupported field size " << options.fieldWidth << "x" << options.fieldHeight << endl;
+                return 1;
+            }
+            if(!options.levelParamsFile.empty() && !world.loadLevelParams(options.levelParamsFile)){
+                cout << "Cannot load level settings " << options.levelParamsFile << endl;
+                return 1;
+            }
+            world.setLevelFile(options.levelFile);
+            world.setAiLod(lod != 0);
+            games++;
+            
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            int status = world.init();
+            while(status != GWSTATUS_LEVEL_ERROR && ticks < options.benchAiTicks){
+                status = world.move();
+                ticks++;
+                if(status == GWSTATUS_PLAYER_DIED){
+                    if(world.isGameOver())
+                        break;
+                    world.cleanUp();
+                    status = world.init();
+                }
+                else if(status == GWSTATUS_FINISHED_LEVEL){
+                    world.advanceToNextLevel();
+                    world.cleanUp();
+                    status = world.init();
+                }
+            }
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            world.cleanUp();
+            if(status == GWSTATUS_LEVEL_ERROR){
+                cout << "Cannot set up a level" << endl;
+                return 1;
+            }
+        }
+        
+        msPerTick[lod] = ticks > 0 ? ms / ticks : 0;
+        cout << "AI level of detail " << (lod ? "on: " : "off: ") << ticks << " ticks over " << games << " games in " << ms
+             << " ms (" << msPerTick[lod] * 1000 << " us/tick)" << endl;
+    }
+    if(msPerTick[1] > 0)
+        cout << "Speedup: " << msPerTick[0] / msPerTick[1] << "x" << endl;
+    return 0;
 }
@@ -4,15 +4,34 @@
 #include "GameWorld.h"
 #include "GameConstants.h"
 #include "GraphObject.h"
+#include "ActorReclaimer.h"
+#include "EarthField.h"
+#include "InputLog.h"
+#include "LevelFile.h"
+#include "LevelGenerator.h"
+#include "LevelParams.h"
+#include "PackedPositions.h"
+#include "TimingWheel.h"
+#include "FreeCellIndex.h"
+#include "WorldSnapshot.h"
+#include "WorldTimeline.h"
+#include "WorkerPool.h"
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <future>
 
 
 //Constants:
 const int actorSize = 4;
+const int numDisplayedStats = 8;
+const int statTextCapacity = 128;
+//How close the TunnelMan has to come for a hidden goodie to show itself (it has to come a little closer to pick one up)
+const int goodieRevealRadius = 4;
+//The side of a square of the grid goodies are filed in by position
+const int goodieBucketSize = 8;
 
 class Actor;
-class Earth;
 class TunnelMan;
 class Boulder;
 class Squirt;
@@ -25,6 +44,15 @@ class Protestor;
 class RegularProtestor;
 class HardCoreProtestor;
 
+//Up to capacity protestors found by a search, held inline so filling it never allocates
+struct ProtestorMatches{
+    static const int capacity = 16;
+    Protestor* protestors[capacity];
+    int count;
+    //set when more protestors matched than there was room for
+    bool truncated;
+};
+
 //This struct allows for a queue-based maze searching algorithm which helps to dictate how protestors move in the field
 struct mazeLocation{
     int x;
@@ -35,6 +63,47 @@ struct mazeLocation{
     }
 };
 
+//The results of one maze search: how many moves each field cell is from the target, moving around earth and boulders
+struct MazeField{
+    std::vector<int> distance;
+    std::vector<bool> visited;
+    int targetX;
+    int targetY;
+    unsigned int version; //the world's maze version the search was run against
+    bool valid;
+};
+
+//What a protestor is going to do on its turn, decided ahead of the actors' turns (see Protestor::decideIntent) along with
+//everything the decision depends on, so it can be checked it still holds when the turn comes
+struct ProtestorIntent{
+    const Protestor* protestor;
+    unsigned int tick;
+    int x;
+    int y;
+    int playerX;
+    int playerY;
+    unsigned int mazeVersion;
+    bool leaving;
+    bool valid;
+    
+    GraphObject::Direction exitDirection;  //the way out, for a protestor that's leaving
+    bool canReachTunnelMan;                //whether it can head for the TunnelMan, for one that isn't
+    GraphObject::Direction chaseDirection; //the way to the TunnelMan, for a hardcore protestor that can head for him
+    
+    ProtestorIntent(){
+        protestor = nullptr;
+        valid = false;
+    }
+};
+
+//The bits of what StudentWorld keeps about each actor to decide whether it gets a turn (see StudentWorld::wantsTurn)
+enum TurnFlag{
+    turnAlive = 1,
+    turnWaiting = 2,   //suspended for ticks or until a world event
+    turnTriggered = 4, //a goodie the TunnelMan came near this tick
+    turnTemporary = 8  //a goodie that expires
+};
+
 
 class StudentWorld : public GameWorld
 {
@@ -47,7 +116,7 @@ public:
 
     virtual void cleanUp();
     
-    virtual ~StudentWorld(){}
+    virtual ~StudentWorld();
     
     //Additional Functions:
     
@@ -55,15 +124,50 @@ public:
     void addActor(Actor* a);
     //removes an actor (except for Earth and TunnelMan) from a location at the field
     void removeActor(Actor* a);
+    //Keeps the world's copy of an actor's position current; Actor::move calls it
+    void actorMoved(Actor* a);
+    //Keeps the world's copy of what decides an actor's turns current; Actor calls it whenever the actor dies or its wait
+    //starts or ends
+    void actorTurnStateChanged(Actor* a);
+    
+    //Returns the number of the tick being played (it counts every tick of the session)
+    unsigned int getTickNumber() const;
+    //Skips an actor's turns until the given tick, at the start of which it gets a wakeUp() call
+    void scheduleWakeUp(Actor* a, unsigned int tick);
+    void cancelWakeUp(Actor* a);
+    //returns whether the actor has had its turn in the tick being played
+    bool hasHadTurnThisTick(const Actor* a) const;
     
     //returns whether the tunnelman is within the given radius
     bool tunnelManWithinRadius(int x, int y, int radius);
     
+    //Returns how many turns' worth of wandering moves a protestor makes at once: 1 normally, or with AI level of detail on,
+    //the stride of the distance band (see LevelParams) it's in. A hardcore protestor that could still track the TunnelMan
+    //down always gets 1
+    int protestorUpdateStride(const Protestor* p) const;
+    
     //Returns a pointer to the TunnelMan
     TunnelMan* getTunnelMan() const;
     
-    //Returns a vector of all the protestors within the given radius
-    std::vector<Actor*> findProtestorsWithinRadius(int x, int y, int radius);
+    //returns the difficulty settings of the current level
+    const LevelParams& getLevelParams() const;
+    
+    //Sets how big the oil field is (at least VIEW_WIDTH x VIEW_HEIGHT, at most maxFieldSize on a side); takes effect at the next init().
+    //Returns false, changing nothing, for an unsupported size
+    bool setFieldSize(int width, int height);
+    int getFieldWidth() const;
+    int getFieldHeight() const;
+    //returns the field position shown at the bottom left corner of the screen, which follows the TunnelMan
+    virtual void getViewOrigin(int& x, int& y) const;
+    
+    //Calls visit(Protestor*) for each live protestor within the given radius, in the order they entered the field, until
+    //visit returns false
+    template<typename Visit>
+    void forEachProtestorWithinRadius(int x, int y, int radius, Visit visit) const;
+    //Returns the first live protestor within the given radius, or nullptr if there isn't one
+    Protestor* findProtestorWithinRadius(int x, int y, int radius) const;
+    //Fills matches with the live protestors within the given radius (the first ProtestorMatches::capacity of them) and returns how many it holds
+    int findProtestorsWithinRadius(int x, int y, int radius, ProtestorMatches& matches) const;
     
     //removes earth objects within a 4x4 location specified by the bottom left corner. If there is no earth object at the given location, it does nothing
     void removeEarth(int x, int y);
@@ -71,6 +175,9 @@ public:
     //returns whether there are earth objects within a given location 4x4 location specfied by the bottom left corner. If the location is not valid, it returns false anyways
     bool earthAt(int x, int y) const;
     
+    //returns whether the single cell at (x, y) has earth; used by the controller to draw the field
+    virtual bool hasEarthCell(int x, int y) const;
+    
     //returns whether any part of an actor located at the given location will overlap with any part of a boulder
     bool actorWillOverlapBoulder(int x, int y) const;
     
@@ -78,19 +185,17 @@ public:
     bool boulderWithinRadius3(int x, int y) const;
     
     //Returns whether any part of an actor would hit a boulder or the edge if it moved one square in the direction d
-    bool willHitBoulderOrEdge(int x, int y, GraphObject::Direction d);
+    bool willHitBoulderOrEdge(int x, int y, GraphObject::Direction d) const;
     //Returns whether any part of an actor would hit a boulder, edge or earth if it moved one square in the direction d
-    bool willHitBoulderEdgeOrEarth(int x, int y, GraphObject::Direction d);
+    bool willHitBoulderEdgeOrEarth(int x, int y, GraphObject::Direction d) const;
     
     //returns whether an actor located at the given coordinate would be entirely within the game's playing field
     bool actorWouldBeWithinField(int x, int y) const;
     
 
-    //annoys all active protestors present within the given radius
-    bool killProtestorsWithinRadius(int x, int y, int radius);
-    
-    //annoys a single active protestor present within the given radius
-    bool squirtProtestorWithinRadius(int x, int y, int radius);
+    //annoys the live protestors within the given radius by howMuch, the first maxProtestors of them (all of them if it's
+    //0), and returns how many it annoyed
+    int annoyProtestorsWithinRadius(int x, int y, int radius, int howMuch, int maxProtestors);
     
     //illuminates all actors in the oil field within the given radius
     void illuminateOilField(int x, int y, int radius);
@@ -98,19 +203,86 @@ public:
     //bribes a single protestor present within the radius
     void bribeProtestor(int x, int y, int radius);
     
-    //Returns the best direction for a character to move in order to get to a certain point in the grid (assuming one can't move into earth or a boulder)
-    GraphObject::Direction getDirectionToLocation(Actor* p, int x, int y);
+    //Returns the maze search to the given target if there's an up to date one, or nullptr. Changes nothing, so the worker
+    //threads can ask
+    const MazeField* freshMazeFieldTo(int x, int y) const;
+    
+    //Returns the best direction for a character at (x, y) to move in to get to a maze search's target (assuming one can't move into earth or a boulder)
+    GraphObject::Direction getDirectionOnField(const MazeField& field, int x, int y) const;
+    
+    //returns whether a character at (x, y) is fewer than movesAway moves from a maze search's target (assuming one can't move into earth or a boulder)
+    bool isWithinMovesOnField(const MazeField& field, int x, int y, int movesAway) const;
+    
+    //Returns what the protestor is going to do on its turn: what was decided for it ahead of the actors' turns if nothing
+    //the decision depends on has changed since, otherwise what it decides now
+    const ProtestorIntent& protestorIntentFor(const Protestor* p);
+    
+    //Returns the next key pressed, recording it when recording and taking it from the log when replaying
+    bool getKey(int& value);
+    
+    //Seeds the random number generator and starts logging every key getKey returns to the given file. The log also keeps
+    //the field size, fast restart and AI level of detail settings, any snapshot waiting to be loaded and checksums of the
+    //level settings and level file, so set those up first
+    bool startRecording(const std::string& path, unsigned int seed);
+    //Loads an input log, seeds the random number generator from it, sets the field size, fast restarts, AI level of detail
+    //and the starting snapshot as the recorded session had them, and feeds its keys to getKey. Load the session's level
+    //settings and set its level file first: a log recorded with different ones would play out differently, so it's
+    //rejected, with the reason in problem
+    bool startReplay(const std::string& path, std::string& problem);
+    //returns whether a replay has played back every tick in its log
+    bool replayFinished() const;
+    //returns the results the replayed session ended with
+    const InputLogResults& getReplayResults() const;
     
-    //returns whether an actor is 'x' moves from the TunnelMan (assuming one can't move into earth or a boulder)
-    bool isXMovesAwayFromTunnelMan(Actor* p, int x);
+    //Writes the world's complete state (earth, actors and their counters, the TunnelMan's inventory, spawn timers) as a snapshot image
+    void saveSnapshot(std::vector<char>& image) const;
+    bool saveSnapshotToFile(const std::string& path) const;
+    //Loads a snapshot file; the next init() restores the world, including level, lives and score, from it instead of generating a level
+    bool loadSnapshotFromFile(const std::string& path);
+    //Writes a snapshot of every freshly generated level, as it stands right after init(), to the given file
+    void setLevelStartSnapshotFile(const std::string& path);
+    //Plays every level on the map in the given level file instead of generating one; init() fails with GWSTATUS_LEVEL_ERROR if it's malformed
+    void setLevelFile(const std::string& path);
+    //Writes every freshly generated level's layout to the given file, in the level file format
+    void setLevelExportFile(const std::string& path);
+    //When enabled, losing a life restores the level exactly as it was first laid out instead of generating a new one
+    void setFastRestart(bool enabled);
+    //Reads a config file of difficulty settings that replace the standard ones (see LevelParamsOverrides)
+    bool loadLevelParams(const std::string& path);
+    //When enabled, protestors far from the TunnelMan act less often, making several moves at a time
+    void setAiLod(bool enabled);
+    
+    //Starts keeping a history of the world as it stood at the start of each tick, within the given memory budget
+    void enableTimeline(size_t memoryBudget, unsigned int keyframeInterval);
+    const WorldTimeline& getTimeline() const;
+    //Puts the world back the way it was at the start of the given (recorded) tick. The images don't hold rand()'s state,
+    //so ticks played on from there needn't match the ones recorded
+    bool seekToTick(unsigned int tick);
     
 
     
     
     
 private:
-    Earth* m_earthTracker[VIEW_HEIGHT][VIEW_WIDTH];
+    EarthField m_earth;
+    //The 4x4 spots with no earth in them, where water pools can show up; rebuilt whenever m_earth is replaced and added to
+    //by removeEarth
+    FreeCellIndex m_freeCells;
+    //Every actor but the TunnelMan, in the order they're updated each tick, and the boulders and protestors among them
+    //(in the same order) for the searches that only care about those
     std::vector<Actor*> m_gameObjects;
+    //The kind and TurnFlag bits of each of m_gameObjects, in the same order, so the tick loop can pass over the actors with
+    //nothing to do without touching them
+    std::vector<uint8_t> m_turnKinds;
+    std::vector<uint8_t> m_turnFlags;
+    std::vector<Boulder*> m_boulders;
+    std::vector<Protestor*> m_protestors;
+    //The positions of the actors in m_boulders and m_protestors, in the same order, for the radius searches
+    PackedPositions m_boulderPositions;
+    PackedPositions m_protestorPositions;
+    //The goodies the TunnelMan can pick up, filed by position so the ones near him can be found without looking at the rest
+    std::vector<std::vector<Goodie*>> m_goodieBuckets;
+    int m_goodieBucketsWide;
     TunnelMan* m_player;
     int m_numBarrels;
     
@@ -118,18 +290,132 @@ private:
     int m_ticksSinceLastProtestorAdded;
     int m_numProtestors;
     
-    void populateFieldWithEarth();
-    void populateFieldWithBoulders();
-    void populateFieldWithBarrels();
-    void populateFieldWithNuggets();
+    //Counts every tick of the session (across levels and lives); the input log is keyed by it
+    unsigned int m_tickNumber;
+    InputLogWriter m_recorder;
+    InputLogReader m_replay;
+    bool m_replaying;
+    
+    //Snapshot waiting to be restored by the next init(), and the snapshot of the current level as first laid out
+    std::vector<char> m_pendingSnapshot;
+    std::vector<char> m_levelStartSnapshot;
+    std::string m_levelStartSnapshotFile;
+    bool m_fastRestart;
+    bool m_aiLod;
+    
+    //Level file to play instead of generating levels (mapped on first use), and where to export generated levels to
+    std::string m_levelFilePath;
+    LevelFile m_levelFile;
+    std::string m_levelExportFile;
+    
+    //The size of the oil field, and the part of it on screen
+    int m_fieldWidth;
+    int m_fieldHeight;
+    int m_viewX;
+    int m_viewY;
+    
+    //The last two maze searches. m_mazeVersion changes whenever earth is dug or a boulder appears, moves or goes away,
+    //so a search is still good as long as it was run against the current version
+    MazeField m_mazeFields[2];
+    int m_recentMazeField;
+    unsigned int m_mazeVersion;
+    
+    //The current level's difficulty settings, and any replacements read from a config file
+    LevelParams m_params;
+    LevelParamsOverrides m_paramOverrides;
+    
+    //The next level's layout, built on a worker thread while the "level finished" prompt is up
+    std::future<LevelLayout> m_nextLayout;
+    
+    //Deletes the actors of finished levels off the game thread
+    ActorReclaimer m_reclaimer;
+    
+    //Runs the maze searches and decides the protestors' intents each tick, and the intents decided, in the same order as
+    //m_protestors
+    WorkerPool m_workers;
+    std::vector<ProtestorIntent> m_protestorIntents;
+    
+    //Wake-ups for actors sleeping until a certain tick, and how many of m_gameObjects have had their turn in the tick being
+    //played (all of them between ticks)
+    TimingWheel m_wheel;
+    std::vector<TimerNode*> m_firedTimers;
+    size_t m_turnsTaken;
+    
+    WorldTimeline m_timeline;
+    std::vector<char> m_timelineImage;
+    
+    //The stats last shown on the HUD, and the text formatted from them
+    int m_displayedStats[numDisplayedStats];
+    bool m_displayedStatsValid;
+    char m_statText[statTextCapacity];
+    
+    //Rebuilds the world from a validated snapshot image
+    void restoreSnapshot(const std::vector<char>& image, bool includeStats);
+    bool isValidSnapshot(const std::vector<char>& image) const;
+    Actor* createActorFromRecord(const ActorRecord& r);
+    
+    //returns the difficulty settings for the given level, with the config file's replacements applied
+    LevelParams paramsForLevel(int level) const;
+    //Return checksums of the level settings file and the level file for input logs, or 0 if there isn't one
+    unsigned int levelParamsChecksum() const;
+    unsigned int levelFileChecksum();
+    
+    //Starts building the next level's layout in the background
+    void prepareNextLevel();
+    //Hands back the layout for the current level: the level file's if there is one, otherwise the one prepared in the
+    //background if it's for this level, or a freshly generated one. Returns false if the level file can't be loaded
+    bool takeLevelLayout(LevelLayout& layout);
+    
+    void populateFieldWithEarth(const EarthField& earth);
+    //Moves the view so it stays centred on the TunnelMan
+    void updateCamera();
+    
+    //Returns a maze search to the given target that's up to date, reusing the last one to it if the maze hasn't changed since
+    const MazeField& mazeFieldTo(int x, int y);
+    //returns the slot to run a search to the given target in, or nullptr if there's an up to date one already
+    MazeField* staleMazeFieldTo(int x, int y);
+    //Runs the searches this tick's protestors are going to ask for ahead of the actors' turns, side by side
+    void prepareMazeFields();
+    //Decides the intents of the protestors that are going to act this tick, side by side, from the searches just run
+    void decideProtestorIntents();
+    //Fills in what an intent depends on and has the protestor decide it
+    void decideProtestorIntent(const Protestor* p, ProtestorIntent& intent) const;
+    //Fills a maze field with how many moves each cell is from the given start. Only reads the world, so two can run at once
+    void computeMazeDistances(MazeField& field, int startX, int startY) const;
+    //returns the distance a search found for a cell, or notValid if the cell is outside the field or unreachable
+    int mazeDistance(const MazeField& field, int x, int y, int notValid) const;
+    size_t mazeIndex(int x, int y) const;
+    void populateFieldWithBoulders(const std::vector<FieldPosition>& positions);
+    void populateFieldWithBarrels(const std::vector<FieldPosition>& positions);
+    void populateFieldWithNuggets(const std::vector<FieldPosition>& positions);
+    
+    //Triggers the goodies within goodieRevealRadius of the given position for this tick
+    void triggerGoodiesNear(int x, int y);
+    std::vector<Goodie*>& goodieBucketAt(int x, int y);
+    void unfileGoodie(Goodie* g);
+    
+    //Signals the ground opening below to the boulders resting on any cell of the rectangle from (left, bottom) up to but not
+    //including (right, top)
+    void wakeBouldersAbove(int left, int bottom, int right, int top);
+    
+    //Returns the TurnFlag bits for an actor
+    uint8_t turnFlagsOf(Actor* a) const;
+    //Returns whether the actor at index i of m_gameObjects has anything to do this tick, going only by m_turnKinds and
+    //m_turnFlags
+    bool wantsTurn(size_t i) const;
+    //Runs the doSomething for its kind of an actor that wants its turn, without a virtual call
+    void updateActor(Actor* a);
+    //Deletes every dead actor, keeping the rest in order
+    void removeDeadActors();
+    
+    //returns whether the protestor at index i of m_protestors is still alive
+    bool isLiveProtestor(size_t i) const;
     
-    bool thereAreObjectsTooClose(int x, int y);
     bool playerCompletedLevel();
     
-    double distanceApart(int x, int y, int x2, int y2) const;
-    bool nearTunnel(int x, int y) const;
+    int squaredDistance(int x, int y, int x2, int y2) const;
     void updateDisplayText();
-    std::string formatStats(int level, int lives, int health, int squirts, int gold, int barrelsLeft, int sonar, int score);
+    void formatStats(int level, int lives, int health, int squirts, int gold, int barrelsLeft, int sonar, int score);
 
     //returns whether there is any part of a boulder present at the given location
     bool boulderAt(int x, int y) const;
@@ -138,5 +424,18 @@ private:
     
 };
 
+template<typename Visit>
+void StudentWorld::forEachProtestorWithinRadius(int x, int y, int radius, Visit visit) const{
+    for(size_t first = 0; first < m_protestors.size(); first += PackedPositions::blockSize){
+        uint64_t hits = m_protestorPositions.withinRadius(first, x, y, radius, true);
+        while(hits != 0){
+            size_t i = first + lowestBit(hits);
+            hits &= hits - 1;
+            if(isLiveProtestor(i) && !visit(m_protestors[i]))
+                return;
+        }
+    }
+}
+
 #endif // STUDENTWORLD_H_
 
@@ -0,0 +1,77 @@
+#ifndef TEXTRENDERER_H_
+#define TEXTRENDERER_H_
+
+#include "freeglut.h"
+#include <string>
+
+  // Draws GLUT stroke text from display lists compiled once per glyph, so a
+  // line of text costs a single glCallLists instead of re-stroking every
+  // character each frame.
+class TextRenderer
+{
+public:
+
+	TextRenderer()
+	 : m_glyphListBase(0)
+	{
+		for (int c = 0; c < NUM_GLYPHS; c++)
+			m_glyphWidth[c] = 0;
+	}
+
+	  // must be called once a GL context exists
+	void init()
+	{
+		if (m_glyphListBase != 0)
+			return;
+
+		m_glyphListBase = glGenLists(NUM_GLYPHS);
+		for (int c = 0; c < NUM_GLYPHS; c++)
+		{
+			glNewList(m_glyphListBase + c, GL_COMPILE);
+			glutStrokeCharacter(GLUT_STROKE_ROMAN, c);
+			glEndList();
+			m_glyphWidth[c] = glutStrokeWidth(GLUT_STROKE_ROMAN, c);
+		}
+	}
+
+	int strokeLength(const std::string& text) const
+	{
+		int length = 0;
+		for (size_t k = 0; k < text.size(); k++)
+		{
+			unsigned char c = static_cast<unsigned char>(text[k]);
+			if (c < NUM_GLYPHS)
+				length += m_glyphWidth[c];
+		}
+		return length;
+	}
+
+	  // draws text at the current modelview origin; each glyph list advances the origin
+	void draw(const std::string& text) const
+	{
+		glListBase(m_glyphListBase);
+		glCallLists(static_cast<GLsizei>(text.size()), GL_UNSIGNED_BYTE, text.c_str());
+	}
+
+	  // must be called while the GL context still exists; the destructor
+	  // can't do it, since the controller singleton outlives the window
+	void release()
+	{
+		if (m_glyphListBase != 0)
+			glDeleteLists(m_glyphListBase, NUM_GLYPHS);
+		m_glyphListBase = 0;
+	}
+
+private:
+
+	static const int NUM_GLYPHS = 128;
+
+	GLuint	m_glyphListBase;
+	int		m_glyphWidth[NUM_GLYPHS];
+
+	  // Prevent copying or assigning TextRenderers
+	TextRenderer(const TextRenderer&);
+	TextRenderer& operator=(const TextRenderer&);
+};
+
+#endif // TEXTRENDERER_H_
@@ -0,0 +1,77 @@
+#include "TimingWheel.h"
+
+using namespace std;
+
+TimingWheel::TimingWheel(){
+    reset(0);
+}
+
+void TimingWheel::reset(unsigned int now){
+    for(int level = 0; level < numLevels; level++){
+        for(int slot = 0; slot < numSlots; slot++){
+            m_slots[level][slot].prev = &m_slots[level][slot];
+            m_slots[level][slot].next = &m_slots[level][slot];
+        }
+    }
+    m_now = now;
+}
+
+void TimingWheel::schedule(TimerNode& node, unsigned int dueTick){
+    if(node.isScheduled())
+        unlink(node);
+    node.dueTick = dueTick > m_now ? dueTick : m_now + 1;
+    insert(node);
+}
+
+void TimingWheel::cancel(TimerNode& node){
+    if(node.isScheduled())
+        unlink(node);
+}
+
+void TimingWheel::advance(unsigned int tick, vector<TimerNode*>& fired){
+    while(m_now != tick){
+        m_now++;
+
+        //At the start of a block, move the timers due in it down from the level above (and, at the start of a bigger
+        //block, into that level from the one above it first)
+        int level = 1;
+        while(level < numLevels && (m_now & ((1u << (slotBits * level)) - 1)) == 0)
+            level++;
+        for(int l = level - 1; l >= 1; l--){
+            TimerNode& head = m_slots[l][(m_now >> (slotBits * l)) & (numSlots - 1)];
+            while(head.next != &head){
+                TimerNode& node = *head.next;
+                unlink(node);
+                insert(node);
+            }
+        }
+
+        TimerNode& head = m_slots[0][m_now & (numSlots - 1)];
+        while(head.next != &head){
+            TimerNode* node = head.next;
+            unlink(*node);
+            fired.push_back(node);
+        }
+    }
+}
+
+void TimingWheel::insert(TimerNode& node){
+    //The level is how far up the first bit where the due tick and now differ is
+    unsigned int differ = node.dueTick ^ m_now;
+    int level = 0;
+    while(level < numLevels - 1 && (differ >> (slotBits * (level + 1))) != 0)
+        level++;
+
+    TimerNode& head = m_slots[level][(node.dueTick >> (slotBits * level)) & (numSlots - 1)];
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+}
+
+void TimingWheel::unlink(TimerNode& node){
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = nullptr;
+    node.next = nullptr;
+}
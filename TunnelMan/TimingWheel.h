@@ -0,0 +1,59 @@
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include <vector>
+
+//A timer that can sit on a TimingWheel. Whoever owns one embeds it and points owner back at itself
+struct TimerNode{
+    TimerNode* prev;
+    TimerNode* next;
+    unsigned int dueTick;
+    void* owner;
+
+    TimerNode(){
+        prev = nullptr;
+        next = nullptr;
+        dueTick = 0;
+        owner = nullptr;
+    }
+
+    bool isScheduled() const{
+        return next != nullptr;
+    }
+};
+
+//Hierarchical timing wheel keyed by tick number. Four levels of 256 slots each: a timer due within the current block of
+//256 ticks sits in the bottom level's slot for its tick, and one due later sits in a higher level's slot until its block
+//comes round, when it's moved down. Scheduling, cancelling and moving on a tick are all O(1) however many timers there are
+class TimingWheel{
+public:
+    TimingWheel();
+
+    //Forgets every timer without touching them (their owners may already be gone) and starts counting from the given tick
+    void reset(unsigned int now);
+
+    unsigned int now() const{
+        return m_now;
+    }
+
+    //Schedules a timer for a tick after now(), moving it if it's already scheduled
+    void schedule(TimerNode& node, unsigned int dueTick);
+    void cancel(TimerNode& node);
+
+    //Moves on, a tick at a time, to the given tick, appending each timer that comes due to fired (it's no longer scheduled)
+    void advance(unsigned int tick, std::vector<TimerNode*>& fired);
+
+private:
+    static constexpr int slotBits = 8;
+    static constexpr int numSlots = 1 << slotBits;
+    static constexpr int numLevels = 4;
+
+    //The heads of each slot's circular list
+    TimerNode m_slots[numLevels][numSlots];
+    unsigned int m_now;
+
+    void insert(TimerNode& node);
+    static void unlink(TimerNode& node);
+};
+
+#endif // TIMINGWHEEL_H_
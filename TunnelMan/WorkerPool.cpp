@@ -0,0 +1,76 @@
+#include "WorkerPool.h"
+
+using namespace std;
+
+WorkerPool::WorkerPool(){
+    m_task = nullptr;
+    m_count = 0;
+    m_next = 0;
+    m_batch = 0;
+    m_busy = 0;
+    m_stopping = false;
+    unsigned int cores = thread::hardware_concurrency();
+    for(unsigned int i = 1; i < cores; i++)
+        m_threads.push_back(thread(&WorkerPool::work, this));
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for(thread& t : m_threads)
+        t.join();
+}
+
+void WorkerPool::run(size_t count, const function<void(size_t)>& task){
+    if(count <= 1 || m_threads.empty()){
+        for(size_t i = 0; i < count; i++)
+            task(i);
+        return;
+    }
+    
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_batch++;
+    }
+    m_wakeUp.notify_all();
+    runTasks(task, count);
+    
+    //Every task has been claimed; wait for the ones still running, then close the batch to threads that wake up late
+    unique_lock<mutex> lock(m_mutex);
+    m_idle.wait(lock, [this](){ return m_busy == 0; });
+    m_task = nullptr;
+}
+
+void WorkerPool::work(){
+    unsigned int joined = 0;
+    unique_lock<mutex> lock(m_mutex);
+    while(true){
+        m_wakeUp.wait(lock, [this, joined](){ return m_stopping || (m_task != nullptr && m_batch != joined); });
+        if(m_stopping)
+            return;
+        
+        joined = m_batch;
+        const function<void(size_t)>& task = *m_task;
+        size_t count = m_count;
+        m_busy++;
+        lock.unlock();
+        
+        runTasks(task, count);
+        
+        lock.lock();
+        m_busy--;
+        if(m_busy == 0)
+            m_idle.notify_one();
+    }
+}
+
+void WorkerPool::runTasks(const function<void(size_t)>& task, size_t count){
+    for(size_t i = m_next++; i < count; i = m_next++)
+        task(i);
+}
@@ -0,0 +1,50 @@
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//Runs batches of independent tasks on a few long-lived threads, with the calling thread helping out, so work split across
+//cores every tick doesn't pay for starting threads. Only one thread may hand it batches
+class WorkerPool{
+public:
+    //Starts one thread for each core but the caller's
+    WorkerPool();
+    //Stops the threads
+    ~WorkerPool();
+    
+    //Calls task(i) for every i from 0 up to count and returns once they've all finished. Tasks run in no particular order
+    //and side by side, so one mustn't write anything another reads
+    void run(size_t count, const std::function<void(size_t)>& task);
+    
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_idle;
+    //The batch being run (nullptr between batches), and the next of its tasks nobody has claimed yet
+    const std::function<void(size_t)>* m_task;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+    //Bumped for every batch, so a thread only joins each one once
+    unsigned int m_batch;
+    //How many threads are working on the batch
+    int m_busy;
+    bool m_stopping;
+    
+    //The loop each thread runs
+    void work();
+    //Claims and runs the batch's tasks until there are none left
+    void runTasks(const std::function<void(size_t)>& task, size_t count);
+    
+    //Prevent copying or assigning WorkerPools
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+};
+
+#endif // WORKERPOOL_H_
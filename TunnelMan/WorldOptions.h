@@ -0,0 +1,30 @@
+#ifndef WORLDOPTIONS_H_
+#define WORLDOPTIONS_H_
+
+#include "GameConstants.h"
+#include <cstddef>
+#include <string>
+
+//Command-line settings that main() passes on to the StudentWorld it creates
+struct WorldOptions{
+    std::string recordFile;         //log the session's seed and keys here (--record)
+    unsigned int seed;              //the seed main() passed to srand
+    std::string loadSnapshotFile;   //start from this snapshot instead of generating level 0 (--load-snapshot)
+    std::string saveSnapshotFile;   //write every freshly generated level's starting state here (--save-snapshot)
+    bool fastRestart;               //restore the level as first laid out after losing a life (--fast-restart)
+    size_t timelineBudget;          //bytes of tick history to keep; 0 keeps none (--timeline megabytes)
+    unsigned int keyframeInterval;  //ticks between full keyframes in the tick history
+    unsigned int seekTick;          //after a replay, seek back to this tick (--seek)
+    std::string levelParamsFile;    //difficulty settings that replace the standard ones (--params)
+    std::string levelFile;          //play this level file on every level instead of generating levels (--level)
+    std::string saveLevelFile;      //write every freshly generated level's layout here as a level file (--save-level)
+    int fieldWidth;                 //size of the generated oil field (--field WIDTHxHEIGHT)
+    int fieldHeight;
+    bool aiLod;                     //far protestors act less often, several moves at a time (--ai-lod)
+    unsigned int benchAiTicks;      //play this many ticks headless without and with aiLod and report timings (--bench-ai)
+
+    WorldOptions() : seed(0), fastRestart(false), timelineBudget(0), keyframeInterval(256), seekTick(0),
+                     fieldWidth(VIEW_WIDTH), fieldHeight(VIEW_HEIGHT), aiLod(false), benchAiTicks(0){}
+};
+
+#endif // WORLDOPTIONS_H_
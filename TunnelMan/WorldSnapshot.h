@@ -0,0 +1,55 @@
+#ifndef WORLDSNAPSHOT_H_
+#define WORLDSNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+//A world snapshot is a flat, fixed-layout image of a StudentWorld, so it can be written to disk, mapped back in and
+//used in place without any parsing:
+//
+//  SnapshotHeader
+//  uint64_t earthRows[fieldHeight * ((fieldWidth+63)/64)]    bit x%64 of word x/64 of row y is set when there is earth at (x, y)
+//  ActorRecord actors[numActors]                             the TunnelMan first, then every other actor in update order
+
+const char snapshotMagic[4] = {'T', 'M', 'W', 'S'};
+const uint32_t snapshotVersion = 1;
+
+struct SnapshotHeader{
+    char magic[4];
+    uint32_t version;
+    uint32_t fieldWidth;
+    uint32_t fieldHeight;
+    uint32_t level;
+    uint32_t lives;
+    uint32_t score;
+    int32_t numBarrels;
+    int32_t minTicksBetweenProtestors;
+    int32_t ticksSinceLastProtestorAdded;
+    int32_t numProtestors;
+    uint32_t numActors;
+};
+
+//Everything needed to rebuild one actor. The meaning of state[] depends on the actor's game ID
+struct ActorRecord{
+    char gameID;
+    uint8_t direction;
+    uint8_t visible;
+    uint8_t alive;
+    int16_t x;
+    int16_t y;
+    int32_t state[6];
+};
+
+//The earth bitmap holds one bit per cell, each row padded out to whole 64-bit words
+inline size_t snapshotEarthWords(const SnapshotHeader& header){
+    return header.fieldHeight * ((header.fieldWidth + 63) / 64);
+}
+
+inline size_t snapshotSize(const SnapshotHeader& header){
+    return sizeof(SnapshotHeader) + snapshotEarthWords(header) * sizeof(uint64_t) + header.numActors * sizeof(ActorRecord);
+}
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "earth rows after the header must stay 8-byte aligned");
+static_assert(sizeof(ActorRecord) == 32, "actor records must keep a fixed on-disk size");
+
+#endif // WORLDSNAPSHOT_H_
@@ -0,0 +1,194 @@
+#include "WorldTimeline.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+//Locating the parts of a snapshot image
+static const SnapshotHeader* headerOf(const vector<char>& image){
+    return reinterpret_cast<const SnapshotHeader*>(image.data());
+}
+
+static size_t earthOffset(){
+    return sizeof(SnapshotHeader);
+}
+
+static size_t actorsOffset(const SnapshotHeader& header){
+    return sizeof(SnapshotHeader) + snapshotEarthWords(header) * sizeof(uint64_t);
+}
+
+static void append(vector<char>& out, const void* data, size_t size){
+    const char* bytes = static_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+template<typename T>
+static T readAt(const vector<char>& in, size_t& pos){
+    T value;
+    memcpy(&value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+
+
+/*                          WorldTimeline implementation                   */
+
+WorldTimeline::WorldTimeline(){
+    m_memoryBudget = 0;
+    m_memoryUsed = 0;
+    m_keyframeInterval = 1;
+    m_lastKeyframeTick = 0;
+}
+
+void WorldTimeline::configure(size_t memoryBudget, unsigned int keyframeInterval){
+    m_entries.clear();
+    m_previousImage.clear();
+    m_memoryBudget = memoryBudget;
+    m_memoryUsed = 0;
+    m_keyframeInterval = max(1u, keyframeInterval);
+    m_lastKeyframeTick = 0;
+}
+
+bool WorldTimeline::isEnabled() const{
+    return m_memoryBudget > 0;
+}
+
+void WorldTimeline::record(unsigned int tick, const vector<char>& image){
+    if(!isEnabled() || image.size() < sizeof(SnapshotHeader))
+        return;
+    
+    //Deltas can only describe worlds with the same field size as the previous tick
+    bool sameShape = !m_previousImage.empty() &&
+                     headerOf(m_previousImage)->fieldWidth == headerOf(image)->fieldWidth &&
+                     headerOf(m_previousImage)->fieldHeight == headerOf(image)->fieldHeight;
+    
+    Entry e;
+    e.tick = tick;
+    e.keyframe = m_entries.empty() || !sameShape || tick - m_lastKeyframeTick >= m_keyframeInterval;
+    if(e.keyframe){
+        e.data = image;
+        m_lastKeyframeTick = tick;
+    }
+    else
+        encodeDelta(m_previousImage, image, e.data);
+    
+    m_memoryUsed += e.data.size();
+    m_entries.push_back(std::move(e));
+    m_previousImage = image;
+    
+    while(m_memoryUsed > m_memoryBudget && evictOldest()){}
+    if(m_memoryUsed <= m_memoryBudget)
+        return;
+    
+    //Only the newest keyframe and its deltas are left. Drop the deltas and base the next tick on a fresh keyframe
+    while(!m_entries.back().keyframe){
+        m_memoryUsed -= m_entries.back().data.size();
+        m_entries.pop_back();
+    }
+    m_previousImage.clear();
+    if(m_memoryUsed > m_memoryBudget)
+        configure(0, m_keyframeInterval); //not even one keyframe fits
+}
+
+bool WorldTimeline::seek(unsigned int tick, vector<char>& image) const{
+    if(m_entries.empty() || tick < m_entries.front().tick || tick > m_entries.back().tick)
+        return false;
+    
+    //Entries are in tick order: find the requested tick, then walk back to the keyframe it's based on
+    size_t target = lower_bound(m_entries.begin(), m_entries.end(), tick,
+                                [](const Entry& e, unsigned int t){ return e.tick < t; }) - m_entries.begin();
+    if(m_entries[target].tick != tick)
+        return false;
+    size_t base = target;
+    while(!m_entries[base].keyframe)
+        base--;
+    
+    image = m_entries[base].data;
+    for(size_t i = base + 1; i <= target; i++)
+        applyDelta(m_entries[i].data, image);
+    return true;
+}
+
+unsigned int WorldTimeline::oldestTick() const{
+    return m_entries.empty() ? 0 : m_entries.front().tick;
+}
+
+unsigned int WorldTimeline::newestTick() const{
+    return m_entries.empty() ? 0 : m_entries.back().tick;
+}
+
+size_t WorldTimeline::memoryUsed() const{
+    return m_memoryUsed;
+}
+
+//A delta is: the new header, then (count, {word index, word}*) for the earth bitmap, then (count, {index, record}*) for
+//the actors. The new header's numActors says how long the actor list is now
+void WorldTimeline::encodeDelta(const vector<char>& from, const vector<char>& to, vector<char>& delta){
+    const SnapshotHeader& fromHeader = *headerOf(from);
+    const SnapshotHeader& toHeader = *headerOf(to);
+    delta.clear();
+    append(delta, &toHeader, sizeof(SnapshotHeader));
+    
+    const uint64_t* fromEarth = reinterpret_cast<const uint64_t*>(from.data() + earthOffset());
+    const uint64_t* toEarth = reinterpret_cast<const uint64_t*>(to.data() + earthOffset());
+    size_t countPos = delta.size();
+    uint32_t count = 0;
+    append(delta, &count, sizeof(count));
+    for(uint32_t i = 0; i < snapshotEarthWords(toHeader); i++){
+        if(fromEarth[i] != toEarth[i]){
+            append(delta, &i, sizeof(i));
+            append(delta, &toEarth[i], sizeof(uint64_t));
+            count++;
+        }
+    }
+    memcpy(delta.data() + countPos, &count, sizeof(count));
+    
+    const ActorRecord* fromActors = reinterpret_cast<const ActorRecord*>(from.data() + actorsOffset(fromHeader));
+    const ActorRecord* toActors = reinterpret_cast<const ActorRecord*>(to.data() + actorsOffset(toHeader));
+    countPos = delta.size();
+    count = 0;
+    append(delta, &count, sizeof(count));
+    for(uint32_t i = 0; i < toHeader.numActors; i++){
+        if(i >= fromHeader.numActors || memcmp(&fromActors[i], &toActors[i], sizeof(ActorRecord)) != 0){
+            append(delta, &i, sizeof(i));
+            append(delta, &toActors[i], sizeof(ActorRecord));
+            count++;
+        }
+    }
+    memcpy(delta.data() + countPos, &count, sizeof(count));
+}
+
+void WorldTimeline::applyDelta(const vector<char>& delta, vector<char>& image){
+    size_t pos = 0;
+    SnapshotHeader header = readAt<SnapshotHeader>(delta, pos);
+    image.resize(snapshotSize(header));
+    memcpy(image.data(), &header, sizeof(header));
+    
+    uint64_t* earth = reinterpret_cast<uint64_t*>(image.data() + earthOffset());
+    uint32_t count = readAt<uint32_t>(delta, pos);
+    for(uint32_t k = 0; k < count; k++){
+        uint32_t i = readAt<uint32_t>(delta, pos);
+        earth[i] = readAt<uint64_t>(delta, pos);
+    }
+    
+    ActorRecord* actors = reinterpret_cast<ActorRecord*>(image.data() + actorsOffset(header));
+    count = readAt<uint32_t>(delta, pos);
+    for(uint32_t k = 0; k < count; k++){
+        uint32_t i = readAt<uint32_t>(delta, pos);
+        actors[i] = readAt<ActorRecord>(delta, pos);
+    }
+}
+
+bool WorldTimeline::evictOldest(){
+    //Never drop the newest keyframe: the deltas recorded after it need it as their base
+    size_t keyframes = count_if(m_entries.begin(), m_entries.end(), [](const Entry& e){ return e.keyframe; });
+    if(keyframes <= 1)
+        return false;
+    
+    do{
+        m_memoryUsed -= m_entries.front().data.size();
+        m_entries.pop_front();
+    }while(!m_entries.empty() && !m_entries.front().keyframe);
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef WORLDTIMELINE_H_
+#define WORLDTIMELINE_H_
+
+#include "WorldSnapshot.h"
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+//Keeps a bounded history of recent world states so any recorded tick can be rebuilt without replaying from tick 0.
+//Every keyframeInterval ticks a full snapshot image is stored; the ticks in between store only what changed since the
+//previous tick (the header, earth rows that changed and actor records that changed). The oldest keyframe and its
+//deltas are dropped whenever the history grows past the memory budget. If even the newest keyframe and its deltas
+//don't fit, the deltas go and the next tick starts a new keyframe; if the keyframe alone doesn't fit, the budget can't
+//hold any history and the timeline turns itself off.
+class WorldTimeline{
+public:
+    WorldTimeline();
+
+    //Clears the history and sets how much memory it may use and how often a full keyframe is stored
+    void configure(size_t memoryBudget, unsigned int keyframeInterval);
+    bool isEnabled() const;
+
+    //Records the world's snapshot image for the given tick. Ticks must be recorded in increasing order
+    void record(unsigned int tick, const std::vector<char>& image);
+
+    //Rebuilds the snapshot image recorded for the given tick. Returns false if that tick is no longer (or not yet) held
+    bool seek(unsigned int tick, std::vector<char>& image) const;
+
+    unsigned int oldestTick() const;
+    unsigned int newestTick() const;
+    size_t memoryUsed() const;
+
+private:
+    struct Entry{
+        unsigned int tick;
+        bool keyframe;
+        std::vector<char> data; //a full image for keyframes, an encoded delta otherwise
+    };
+
+    std::deque<Entry> m_entries;
+    std::vector<char> m_previousImage;
+    size_t m_memoryBudget;
+    size_t m_memoryUsed;
+    unsigned int m_keyframeInterval;
+    unsigned int m_lastKeyframeTick;
+
+    static void encodeDelta(const std::vector<char>& from, const std::vector<char>& to, std::vector<char>& delta);
+    static void applyDelta(const std::vector<char>& delta, std::vector<char>& image);
+    //Drops the oldest keyframe and its deltas. Returns false, dropping nothing, if only the newest keyframe is left
+    bool evictOldest();
+};
+
+#endif // WORLDTIMELINE_H_
@@ -1,4 +1,5 @@
 #include "GameController.h"
+#include "WorldOptions.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -14,10 +15,84 @@ const string assetDirectory = "Assets";
 
 class GameWorld;
 
-GameWorld* createStudentWorld(string assetDir = "");
+GameWorld* createStudentWorld(string assetDir = "", const WorldOptions& options = WorldOptions());
+int replayStudentWorld(string assetDir, string logFile, const WorldOptions& options);
+int benchStudentWorld(string assetDir, const WorldOptions& options);
+
+  // Usage: TunnelMan [options] [GLUT options]
+  //   --record logfile		log the session's random seed and key presses
+  //   --replay logfile		play such a log back without a window, as fast as possible, and check the result
+  //   --load-snapshot file	start from a saved world snapshot (kept in the input log when recording)
+  //   --save-snapshot file	save each freshly generated level's starting state
+  //   --fast-restart		after losing a life, restore the level as first laid out (kept in the input log when recording)
+  //   --timeline megabytes	keep a history of recent ticks within that much memory
+  //   --seek tick			with --replay and --timeline, seek back to that tick afterwards
+  //   --params file		replace standard difficulty settings with those in file (pass it again to --replay,
+  //						which rejects a log recorded with different settings)
+  //   --level file			play the map in a level file on every level (pass it again to --replay, which
+  //						rejects a log recorded with a different file)
+  //   --save-level file	save each freshly generated level's layout as a level file
+  //   --field WxH			generate oil fields W by H cells big, e.g. 512x512 (kept in the input log when recording)
+  //   --newest-key-only	act only on the newest key pressed since the last tick, dropping older ones
+  //   --input-stats		on exit, report how many keys were used or dropped and how long they waited
+  //   --ai-lod				far protestors act less often, several moves at a time (kept in the input log when recording)
+  //   --bench-ai ticks		play that many ticks without a window, with AI level of detail off and then on, and
+  //						report the timings (uses --field, --params and --level)
 
 int main(int argc, char* argv[])
 {
+	WorldOptions options;
+	string replayFile;
+	bool reportInputStats = false;
+	int glutArgc = 0;
+	for (int k = 0; k < argc; k++)
+	{
+		string arg = argv[k];
+		if (arg == "--record"  &&  k+1 < argc)
+			options.recordFile = argv[++k];
+		else if (arg == "--load-snapshot"  &&  k+1 < argc)
+			options.loadSnapshotFile = argv[++k];
+		else if (arg == "--save-snapshot"  &&  k+1 < argc)
+			options.saveSnapshotFile = argv[++k];
+		else if (arg == "--fast-restart")
+			options.fastRestart = true;
+		else if (arg == "--timeline"  &&  k+1 < argc)
+			options.timelineBudget = static_cast<size_t>(atof(argv[++k]) * 1024 * 1024);
+		else if (arg == "--seek"  &&  k+1 < argc)
+			options.seekTick = static_cast<unsigned int>(atoi(argv[++k]));
+		else if (arg == "--level"  &&  k+1 < argc)
+			options.levelFile = argv[++k];
+		else if (arg == "--save-level"  &&  k+1 < argc)
+			options.saveLevelFile = argv[++k];
+		else if (arg == "--field"  &&  k+1 < argc)
+		{
+			string size = argv[++k];
+			size_t x = size.find('x');
+			options.fieldWidth = atoi(size.c_str());
+			options.fieldHeight = (x == string::npos ? options.fieldWidth : atoi(size.c_str() + x + 1));
+		}
+		else if (arg == "--newest-key-only")
+			Game().setKeyDrainPolicy(newestKeyOnly);
+		else if (arg == "--input-stats")
+			reportInputStats = true;
+		else if (arg == "--ai-lod")
+			options.aiLod = true;
+		else if (arg == "--bench-ai"  &&  k+1 < argc)
+			options.benchAiTicks = static_cast<unsigned int>(atoi(argv[++k]));
+		else if (arg == "--params"  &&  k+1 < argc)
+			options.levelParamsFile = argv[++k];
+		else if (arg == "--replay"  &&  k+1 < argc)
+			replayFile = argv[++k];
+		else
+			argv[glutArgc++] = argv[k];
+	}
+	argc = glutArgc;
+
+	if (!replayFile.empty())
+		return replayStudentWorld(assetDirectory, replayFile, options);
+	if (options.benchAiTicks > 0)
+		return benchStudentWorld(assetDirectory, options);
+
 	{
 		string path = assetDirectory;
 		if (!path.empty())
@@ -33,8 +108,18 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	srand(static_cast<unsigned int>(time(nullptr)));
+	options.seed = static_cast<unsigned int>(time(nullptr));
+	srand(options.seed);
 
-	GameWorld* gw = createStudentWorld(assetDirectory);
+	GameWorld* gw = createStudentWorld(assetDirectory, options);
 	Game().run(argc, argv, gw, "TunnelMan");
+
+	const InputLatencyStats& stats = Game().getInputLatencyStats();
+	if (reportInputStats  &&  stats.keysConsumed > 0)
+	{
+		cout << "Input latency: " << stats.keysConsumed << " keys, "
+			 << stats.keysDropped << " dropped, average "
+			 << stats.totalLatencyMs / stats.keysConsumed << " ms, max "
+			 << stats.maxLatencyMs << " ms" << endl;
+	}
 }